@@ -0,0 +1,76 @@
+// Network throughput benchmark: N client threads, each pipelining SET
+// commands over its own connection for a fixed duration.
+//
+//   g++ -std=c++17 -O2 -pthread bench/net_bench.cpp -o net_bench
+//   ./net_bench [port] [connections] [pipeline] [seconds]
+//
+// Run it once against `redis_server <port> epoll` and once against
+// `redis_server <port> io_uring`; the server prints its event loop syscall
+// count on shutdown so both ops/sec and syscalls/command can be compared.
+#include <iostream>
+#include <string>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#include <unistd.h>
+
+int main(int argc, char* argv[]) {
+    int port      = argc > 1 ? std::stoi(argv[1]) : 6380;
+    int conns     = argc > 2 ? std::stoi(argv[2]) : 50;
+    int pipeline  = argc > 3 ? std::stoi(argv[3]) : 16;
+    int seconds   = argc > 4 ? std::stoi(argv[4]) : 5;
+
+    std::atomic<bool> stop{false};
+    std::atomic<long> ops{0};
+    std::vector<std::thread> workers;
+
+    for (int t = 0; t < conns; ++t) {
+        workers.emplace_back([&, t]() {
+            int fd = socket(AF_INET, SOCK_STREAM, 0);
+            sockaddr_in addr{};
+            addr.sin_family = AF_INET;
+            addr.sin_port = htons(static_cast<uint16_t>(port));
+            inet_pton(AF_INET, "127.0.0.1", &addr.sin_addr);
+            if (connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0) {
+                std::cerr << "connect failed\n";
+                close(fd);
+                return;
+            }
+            int one = 1;
+            setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+
+            std::string key = "bench:" + std::to_string(t);
+            std::string cmd = "*3\r\n$3\r\nSET\r\n$" + std::to_string(key.size()) + "\r\n" + key
+                            + "\r\n$5\r\nvalue\r\n";
+            std::string batch;
+            for (int i = 0; i < pipeline; ++i) batch += cmd;
+            const size_t expect = static_cast<size_t>(pipeline) * 5; // "+OK\r\n"
+            char buf[16384];
+
+            while (!stop) {
+                if (send(fd, batch.data(), batch.size(), MSG_NOSIGNAL) != static_cast<ssize_t>(batch.size())) break;
+                size_t got = 0;
+                while (got < expect) {
+                    ssize_t n = recv(fd, buf, sizeof(buf), 0);
+                    if (n <= 0) { stop = true; break; }
+                    got += static_cast<size_t>(n);
+                }
+                ops += pipeline;
+            }
+            close(fd);
+        });
+    }
+
+    std::this_thread::sleep_for(std::chrono::seconds(seconds));
+    stop = true;
+    for (auto &w : workers) w.join();
+
+    std::cout << conns << " connections, pipeline " << pipeline << ": "
+              << ops.load() / seconds << " ops/sec\n";
+    return 0;
+}
@@ -0,0 +1,75 @@
+#ifndef CLIENT_TRACKING_H
+#define CLIENT_TRACKING_H
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+// Server-assisted client side caching (CLIENT TRACKING).
+// Default mode remembers which clients read which keys; broadcast mode
+// matches modified keys against per-client prefixes. Modified keys are
+// turned into per-client invalidations that the event loop delivers.
+class ClientTracking {
+public:
+    static constexpr size_t DEFAULT_MAX_KEYS = 1000000;
+
+    struct Invalidation {
+        uint64_t client = 0;
+        std::vector<std::string> keys;
+        bool flushAll = false; // every cached key is stale
+    };
+
+    explicit ClientTracking(size_t maxKeys = DEFAULT_MAX_KEYS);
+
+    void enable(uint64_t client, bool bcast, std::vector<std::string> prefixes, bool noloop);
+    void disable(uint64_t client);
+
+    // Default mode: remember that client read key. Call before the read so a
+    // concurrent modification cannot slip in between.
+    void trackRead(uint64_t client, const std::string &key);
+
+    // Thread safe; called by Database (under db_mutex) for every modified
+    // key, or with nullptr when the whole keyspace was flushed.
+    void keyModified(const std::string *key);
+
+    // Client whose command is running on this thread (for NOLOOP); 0 = none
+    static void setCurrentClient(uint64_t client);
+
+    std::vector<Invalidation> takeInvalidations();
+    bool hasInvalidations() const { return pending_count.load(std::memory_order_relaxed) > 0; }
+
+private:
+    using KeyTable = std::unordered_map<std::string, std::unordered_set<uint64_t>>;
+
+    struct ClientInfo {
+        bool bcast = false;
+        bool noloop = false;
+        std::vector<std::string> prefixes; // bcast only; empty = every key
+    };
+
+    void queueUnlocked(uint64_t client, const std::string *key);
+    // Remove client from the readers of every key it read (default mode)
+    void forgetReadsUnlocked(uint64_t client);
+    // Erase a table entry and its reverse entries
+    void eraseKeyUnlocked(KeyTable::iterator it);
+
+    std::mutex mutex;
+    size_t max_keys;
+    std::atomic<size_t> active_clients{0};
+    std::atomic<size_t> pending_count{0};
+
+    std::unordered_map<uint64_t, ClientInfo> clients;
+    std::vector<uint64_t> bcast_clients;
+    // key -> clients that may have it cached (default mode)
+    KeyTable table;
+    // Reverse of `table`, so a disabled client's ids are removed at once.
+    // Points at the keys stored in `table`; entries are dropped together.
+    std::unordered_map<uint64_t, std::unordered_set<const std::string *>> client_keys;
+    std::unordered_map<uint64_t, Invalidation> pending;
+};
+
+#endif // CLIENT_TRACKING_H
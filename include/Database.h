@@ -7,6 +7,13 @@
 #include <optional>
 #include <mutex>
 #include <chrono>
+#include <deque>
+#include <memory>
+#include <condition_variable>
+#include <thread>
+#include <functional>
+
+#include "KeyProfiler.h"
 
 class Database {
 public:
@@ -22,6 +29,11 @@ public:
     // ----- List commands -----
     size_t lpush(const std::string& key, const std::vector<std::string>& values);
     std::optional<std::string> lpop(const std::string& key);
+    size_t rpush(const std::string& key, const std::vector<std::string>& values);
+    std::optional<std::string> rpop(const std::string& key);
+    // Atomically pop from one end of src and push to one end of dst
+    std::optional<std::string> lmove(const std::string& src, const std::string& dst,
+                                     bool fromLeft, bool toLeft);
     // LRANGE [start, stop] inclusive (supports negatives similar to Redis)
     std::vector<std::string> lrange(const std::string& key, int start, int stop);
 
@@ -32,17 +44,38 @@ public:
     long ttl(const std::string& key);
     // KEYS pattern (supports '*' and '?')
     std::vector<std::string> keys(const std::string& pattern);
+    // Glob match used by KEYS ('*' and '?')
+    static bool globMatch(const std::string& str, const std::string& pattern);
 
     // Called by background thread and opportunistically on access
     void purgeExpired();
+    // Remove every key; with async the old data is freed by the lazy free thread
+    void flushAll(bool async);
+
+    // ----- Lazy freeing -----
+    // Values with more elements than this are unlinked from the keyspace
+    // immediately and destroyed on the lazy free thread instead of under db_mutex.
+    static constexpr size_t LAZYFREE_THRESHOLD = 64;
+
+    // ----- Keyspace change hook -----
+    // Called under db_mutex with each modified key, or nullptr when every
+    // key was flushed (used for client side caching invalidation)
+    using KeyChangedHook = std::function<void(const std::string*)>;
+    void setKeyChangedHook(KeyChangedHook hook);
+
+    // ----- Hot/big key profiling -----
+    KeyProfiler& profiler() { return key_profiler; }
+    // One round of the background big-key sampler: measures random keys of
+    // each type plus the current biggest ones (bounded by bigKeySamples())
+    void sampleBigKeys();
 
     // ----- Persistence -----
     bool dump(const std::string& filename);
     bool load(const std::string& filename);
 
 private:
-    Database() = default;
-    ~Database() = default;
+    Database();
+    ~Database();
     Database(const Database&) = delete;
     Database& operator=(const Database&) = delete;
 
@@ -51,7 +84,13 @@ private:
     bool isExpiredUnlocked(const std::string& key,
                            const std::chrono::steady_clock::time_point& now) const;
     void removeKeyUnlocked(const std::string& key);
-    static bool globMatch(const std::string& str, const std::string& pattern);
+    // Drops the value stored at key (any type), keeping its expiry; true if one existed
+    bool dropValueUnlocked(const std::string& key);
+    void keyChangedUnlocked(const std::string* key);
+    template <typename T>
+    void lazyFree(T&& obj);
+    // Body of the background free thread; returns once stopped and drained
+    void runLazyFree();
 
 private:
     mutable std::mutex db_mutex;
@@ -63,6 +102,18 @@ private:
 
     // Expiries (not persisted): absolute deadlines (steady_clock)
     std::unordered_map<std::string, std::chrono::steady_clock::time_point> expiries;
+
+    KeyChangedHook key_changed_hook;
+
+    // Sampled from every key lookup; thread safe on its own
+    mutable KeyProfiler key_profiler;
+
+    // Values waiting to be destroyed by the lazy free thread
+    std::mutex lazyfree_mutex;
+    std::condition_variable lazyfree_cv;
+    std::deque<std::shared_ptr<void>> lazyfree_queue;
+    bool lazyfree_stop = false;
+    std::thread lazyfree_thread;
 };
 
 #endif // DATABASE_H
@@ -0,0 +1,90 @@
+#ifndef IO_URING_H
+#define IO_URING_H
+
+#include <linux/io_uring.h>
+#include <cstddef>
+#include <cstdint>
+
+// Minimal io_uring wrapper on top of the raw syscalls (no liburing needed).
+// Covers exactly what the server uses: SQE/CQE rings, one provided buffer
+// ring, and a timed submit-and-wait.
+class IoUring {
+public:
+    IoUring() = default;
+    ~IoUring();
+    IoUring(const IoUring&) = delete;
+    IoUring& operator=(const IoUring&) = delete;
+
+    // True when the running kernel has everything the io_uring backend needs
+    // (multishot accept/recv and provided buffer rings).
+    static bool supported();
+
+    // Returns false (errno set) if the ring could not be created.
+    bool init(unsigned entries);
+
+    // Register a provided buffer ring of `count` buffers of `size` bytes
+    // (count must be a power of two). Returns false on failure.
+    bool setupBufferRing(uint16_t group, unsigned count, unsigned size);
+    char* buffer(uint16_t bid) const { return buf_base + static_cast<size_t>(bid) * buf_size; }
+    unsigned bufferSize() const { return buf_size; }
+    // Hand a consumed buffer back to the kernel.
+    void recycleBuffer(uint16_t bid);
+
+    // Next free SQE (zeroed). Flushes the queue to the kernel if it is full;
+    // returns nullptr only if that did not free a slot.
+    io_uring_sqe* getSqe();
+    // Submit queued SQEs without waiting. Returns number submitted or -errno.
+    int submit();
+    // Submit queued SQEs and wait up to timeout_ms for at least one CQE.
+    // Returns number submitted or -errno.
+    int submitAndWait(int timeout_ms);
+    // Number of io_uring_enter calls made so far
+    uint64_t enterCalls() const { return enter_calls; }
+
+    // Iterate completions: peek, then advance by one once handled.
+    io_uring_cqe* peekCqe();
+    void cqeSeen();
+
+private:
+    // Entry idx of the provided buffer ring. The ring is a plain array of
+    // io_uring_buf; in C++ the uapi flex-array wrapper puts `bufs` at
+    // offset 8, so br->bufs[] must not be used.
+    io_uring_buf& ringEntry(unsigned idx) {
+        return reinterpret_cast<io_uring_buf*>(br)[idx & (buf_count - 1)];
+    }
+
+    int ring_fd = -1;
+    uint64_t enter_calls = 0;
+
+    // Submission queue
+    void* sq_ptr = nullptr;
+    size_t sq_len = 0;
+    unsigned* sq_head = nullptr;
+    unsigned* sq_tail = nullptr;
+    unsigned* sq_mask = nullptr;
+    unsigned* sq_array = nullptr;
+    io_uring_sqe* sqes = nullptr;
+    size_t sqes_len = 0;
+    unsigned sq_entries = 0;
+    unsigned sqe_tail = 0;     // local tail, published on submit
+    unsigned sqe_submitted = 0;
+
+    // Completion queue
+    void* cq_ptr = nullptr;
+    size_t cq_len = 0;
+    unsigned* cq_head = nullptr;
+    unsigned* cq_tail = nullptr;
+    unsigned* cq_mask = nullptr;
+    io_uring_cqe* cqes = nullptr;
+
+    // Provided buffer ring
+    io_uring_buf_ring* br = nullptr;
+    size_t br_len = 0;
+    char* buf_base = nullptr;
+    unsigned buf_count = 0;
+    unsigned buf_size = 0;
+    uint16_t buf_group = 0;
+    uint16_t br_tail = 0;
+};
+
+#endif // IO_URING_H
@@ -0,0 +1,106 @@
+#ifndef KEY_PROFILER_H
+#define KEY_PROFILER_H
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// Hot-key and big-key detection (HOTKEYS, redis_server --scan).
+// A sampled fraction of key accesses feeds a count-min sketch; keys whose
+// estimate is among the K largest are kept in a min-heap. Key sizes are
+// sampled separately by a background thread (see Database::sampleBigKeys)
+// and reported as per-type distributions plus the largest keys seen.
+class KeyProfiler {
+public:
+    static constexpr uint32_t DEFAULT_SAMPLE_RATE = 100; // 1 in N accesses
+    static constexpr uint32_t MAX_SAMPLE_RATE = 1000000;
+    static constexpr size_t DEFAULT_BIGKEY_SAMPLES = 256; // keys per type per round
+    static constexpr size_t MAX_BIGKEY_SAMPLES = 100000;
+    static constexpr size_t DEFAULT_TOP_K = 32;
+    static constexpr size_t SKETCH_WIDTH = 4096; // counters per row (power of two)
+    static constexpr size_t SKETCH_DEPTH = 4;
+    // Counters and heap counts are halved after this many accesses (sample
+    // weights summed) so keys that cool down leave the top-K
+    static constexpr uint64_t DECAY_ACCESSES = 1 << 22;
+
+    enum KeyType { TYPE_STRING, TYPE_LIST, TYPE_HASH, TYPE_COUNT };
+
+    struct HotKey {
+        std::string key;
+        uint64_t count = 0; // sketch estimate in accesses, decayed: not a total
+    };
+
+    // Size distribution of one key type: strings in bytes, lists in items,
+    // hashes in fields
+    struct SizeStats {
+        static constexpr size_t RESERVOIR = 4096;
+        static constexpr size_t BIGGEST = 10;
+
+        uint64_t keys = 0;               // keys of this type in the keyspace/snapshot
+        uint64_t sampled = 0;            // sizes passed to add()
+        uint64_t total = 0;              // sum of sampled sizes
+        std::vector<size_t> sizes;       // uniform reservoir of sampled sizes
+        std::vector<std::pair<std::string, size_t>> biggest; // largest first
+
+        void add(const std::string &key, size_t size);
+        // Candidate for `biggest` only; does not affect the distribution
+        void offerBiggest(const std::string &key, size_t size);
+    };
+
+    explicit KeyProfiler(size_t topK = DEFAULT_TOP_K);
+
+    // Lookup path: cheap unless this access is sampled. Thread safe.
+    void access(const std::string &key) {
+        if (uint32_t weight = sampleWeight()) record(key, weight);
+    }
+
+    void setSampleRate(uint32_t rate) { sample_rate.store(rate, std::memory_order_relaxed); }
+    uint32_t sampleRate() const { return sample_rate.load(std::memory_order_relaxed); }
+    void setBigKeySamples(size_t n) { bigkey_samples.store(n, std::memory_order_relaxed); }
+    size_t bigKeySamples() const { return bigkey_samples.load(std::memory_order_relaxed); }
+
+    // Hottest keys first, with decayed access count estimates
+    std::vector<HotKey> hotKeys(size_t count) const;
+    // Keys currently listed as biggest for a type (re-measured each round)
+    std::vector<std::string> biggestKeys(KeyType type) const;
+    // Replace the size distributions with the latest sampling round
+    void setSizeStats(SizeStats stats[TYPE_COUNT]);
+    void reset();
+
+    // HOTKEYS REPORT text: hot keys followed by the size distributions
+    std::string report() const;
+    static std::string formatSizes(const SizeStats stats[TYPE_COUNT]);
+
+    // Offline mode: exact size distributions from a dump file; false if unreadable
+    static bool scanSnapshot(const std::string &filename, std::string &out);
+
+private:
+    // 0 to skip this access, otherwise the sample rate it stands for
+    uint32_t sampleWeight();
+    void record(const std::string &key, uint32_t weight);
+    uint64_t incrementSketch(uint64_t hash, uint64_t weight);
+    void decayUnlocked();
+    void siftUp(size_t i);
+    void siftDown(size_t i);
+    void swapEntries(size_t a, size_t b);
+
+    std::atomic<uint32_t> sample_rate{DEFAULT_SAMPLE_RATE};
+    std::atomic<size_t> bigkey_samples{DEFAULT_BIGKEY_SAMPLES};
+    size_t top_k;
+
+    mutable std::mutex mutex;
+    // SKETCH_DEPTH rows of SKETCH_WIDTH, in accesses: each sample adds the
+    // rate in force when it was taken, so changing the rate keeps counts right
+    std::vector<uint64_t> sketch;
+    uint64_t samples = 0;         // since the last reset
+    uint64_t since_decay = 0;     // accesses, not samples
+    std::vector<HotKey> heap;     // min-heap on count
+    std::unordered_map<std::string, size_t> heap_pos;
+    SizeStats size_stats[TYPE_COUNT];
+};
+
+#endif // KEY_PROFILER_H
@@ -3,8 +3,21 @@
 
 #include <string>
 #include <vector>
+#include <cstdint>
 
 class Database; // forward declaration
+class ClientTracking;
+
+// A blocking pop (BLPOP/BRPOP/BLMOVE) that found all its keys empty.
+// The server parks the client and retries when one of the keys is pushed to.
+struct BlockedPop {
+    std::vector<std::string> keys;
+    bool fromLeft = true;
+    bool isMove = false;   // BLMOVE: push the popped element to dest
+    std::string dest;
+    bool toLeft = true;
+    double timeout = 0;    // seconds, 0 = block forever
+};
 
 class RedisCommandHandler {
 public:
@@ -13,11 +26,45 @@ public:
     // Parse RESP or plain text commands into vector<string>
     static std::vector<std::string> parseRespCommand(const std::string &input);
 
+    // Parse one complete command from the front of a (possibly pipelined)
+    // buffer. Returns bytes consumed, 0 if the command is still incomplete,
+    // or RESP_PROTOCOL_ERROR if the input is malformed.
+    static constexpr size_t RESP_PROTOCOL_ERROR = static_cast<size_t>(-1);
+    // Input limits; exceeding one is a protocol error. Bulk length and query
+    // buffer match the Redis defaults (proto-max-bulk-len, client-query-buffer-limit).
+    static constexpr long MAX_MULTIBULK_LEN = 1024 * 1024;
+    static constexpr long MAX_BULK_LEN = 512L * 1024 * 1024;
+    static constexpr size_t MAX_INLINE_LEN = 64 * 1024;
+    static constexpr size_t MAX_QUERY_BUFFER = 1024UL * 1024 * 1024;
+    static size_t parseRespFrame(const char *data, size_t len,
+                                 std::vector<std::string> &tokens);
+
     // Process one command (RESP or plain text) -> RESP reply
     std::string processCommand(const std::string &commandLine);
+    // Process an already tokenized command -> RESP reply. If `blocked` is
+    // given and a blocking pop finds nothing, it is filled in and the reply
+    // is empty; without it such commands reply nil immediately.
+    std::string processCommand(const std::vector<std::string> &tokens,
+                               BlockedPop *blocked = nullptr);
+
+    // Retry a parked pop against `key`; on success stores the reply.
+    bool serveBlockedPop(const BlockedPop &b, const std::string &key, std::string &reply);
+
+    // Keys read by following commands are registered for invalidation on
+    // behalf of `clientId` (CLIENT TRACKING); pass nullptr to stop.
+    void setReadTracker(ClientTracking *tracker, uint64_t clientId);
+
+    // Lists that received elements since the last call (wake-up candidates)
+    bool hasReadyKeys() const { return !ready_keys_.empty(); }
+    std::vector<std::string> takeReadyKeys();
 
 private:
+    void trackRead(const std::string &key);
+
     Database &db_;
+    std::vector<std::string> ready_keys_;
+    ClientTracking *tracker_ = nullptr;
+    uint64_t tracker_client_ = 0;
 };
 
 #endif // REDIS_COMMAND_HANDLER_H
@@ -1,21 +1,110 @@
 #ifndef REDIS_SERVER_H
 #define REDIS_SERVER_H
 
+#include "RedisCommandHandler.h"
+#include "ClientTracking.h"
+
 #include <atomic>
+#include <chrono>
+#include <deque>
+#include <map>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <cstdint>
+
+class IoUring; // forward declaration
+
+// Network backend used by the event loop. Auto picks io_uring when the
+// kernel supports it and falls back to epoll otherwise.
+enum class IoBackend { Auto, Epoll, IoUring };
 
 class RedisServer {
 public:
-    explicit RedisServer(int port);
-    ~RedisServer() = default;
+    explicit RedisServer(int port, IoBackend backend = IoBackend::Auto);
+    ~RedisServer();
 
     void run();
     void shutdown();
     void setupSignalHandler();
 
 private:
+    using Deadlines = std::multimap<std::chrono::steady_clock::time_point, int>;
+
+    // Per-client connection state shared by both backends
+    struct Connection {
+        int fd = -1;
+        uint64_t id = 0;        // CLIENT ID, never reused
+        int proto = 2;          // RESP version chosen with HELLO
+        std::string peer;       // "ip:port", for logging
+        std::string inbuf;
+        std::string outbuf;     // replies waiting to be sent
+        std::string inflight;   // replies handed to the kernel (io_uring)
+        size_t inflightSent = 0;
+        bool sendPending = false;
+        bool recvArmed = false;
+        bool epollOut = false;  // EPOLLOUT currently registered
+        bool closing = false;   // QUIT seen or protocol error: close after flush
+        bool dead = false;      // peer closed or socket error (epoll)
+        bool shutdownIssued = false;
+
+        // Parked on a blocking pop; input is not processed until it is served
+        bool blocked = false;
+        BlockedPop block;
+        Deadlines::iterator deadline;
+        bool hasDeadline = false;
+
+        // CLIENT TRACKING state
+        bool tracking = false;
+        bool trackingBcast = false;
+        uint64_t redirect = 0;  // client receiving our invalidations; 0 = self
+        bool subscribedInvalidate = false; // SUBSCRIBE __redis__:invalidate (RESP2)
+    };
+
+    bool setupListenSocket();
+    // Parse and execute every complete command in c.inbuf, appending replies
+    void processInput(Connection &c);
+    // HELLO, CLIENT and SUBSCRIBE act on the connection rather than the
+    // keyspace; returns false if tokens is not one of them
+    bool processConnectionCommand(Connection &c, const std::vector<std::string> &tokens,
+                                  std::string &reply);
+    std::string clientTrackingCommand(Connection &c, const std::vector<std::string> &tokens);
+    void deliverInvalidations();
+
+    // Blocking pops: clients are queued per key and served in FIFO order
+    void blockClient(Connection &c, BlockedPop &&block);
+    void unblockClient(Connection &c);
+    void serveBlockedClients();
+    void expireBlockedClients();
+    int loopTimeoutMs() const;
+
+    void runEpoll();
+    void flushEpoll(int epfd, int fd);
+    bool runIoUring(); // false if the ring could not be set up
+    void armAccept(IoUring &ring);
+    void armRecv(IoUring &ring, Connection &c);
+    void armSend(IoUring &ring, Connection &c);
+    Connection &addConnection(int fd);
+    void closeConnection(int fd);
+
     int port;
+    IoBackend backend;
     int server_socket = -1;
     std::atomic<bool> running{false};
+    RedisCommandHandler handler;
+    std::unordered_map<int, Connection> clients;
+    std::vector<int> touched; // connections with new output or state this round
+    std::unordered_map<uint64_t, int> fd_by_id;
+    uint64_t next_client_id = 1;
+    ClientTracking tracking;
+
+    std::unordered_map<std::string, std::deque<int>> blocked_keys;
+    Deadlines block_deadlines;
+    bool serving_blocked = false;
+
+    // Counters reported on shutdown (syscalls issued by the event loop)
+    uint64_t stat_commands = 0;
+    uint64_t stat_syscalls = 0;
 };
 
 #endif // REDIS_SERVER_H
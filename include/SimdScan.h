@@ -0,0 +1,25 @@
+#ifndef SIMD_SCAN_H
+#define SIMD_SCAN_H
+
+#include <cstddef>
+
+// Byte scanning kernels used by the RESP parser and the KEYS glob matcher.
+// The widest implementation the CPU supports (AVX2, SSE2, scalar) is picked
+// at startup; all levels return identical results.
+class SimdScan {
+public:
+    enum class Level { Scalar, SSE2, AVX2 };
+
+    static Level level();
+    static Level bestLevel();
+    // Force a level (clamped to what the CPU supports); for benchmarks
+    static void setLevel(Level l);
+    static const char* levelName(Level l);
+
+    // First occurrence of c in [p, end), or end
+    static const char* findChar(const char* p, const char* end, char c);
+    // First occurrence of needle[0..n) in [p, end), or end. n must be > 0.
+    static const char* findLiteral(const char* p, const char* end, const char* needle, size_t n);
+};
+
+#endif // SIMD_SCAN_H
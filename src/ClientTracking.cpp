@@ -0,0 +1,135 @@
+#include "ClientTracking.h"
+
+#include <algorithm>
+
+static thread_local uint64_t t_current_client = 0;
+
+ClientTracking::ClientTracking(size_t maxKeys) : max_keys(maxKeys) {}
+
+void ClientTracking::setCurrentClient(uint64_t client) {
+    t_current_client = client;
+}
+
+void ClientTracking::enable(uint64_t client, bool bcast, std::vector<std::string> prefixes,
+                            bool noloop) {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto &info = clients[client];
+    bool wasBcast = info.bcast;
+    info.bcast = bcast;
+    info.noloop = noloop;
+    info.prefixes = std::move(prefixes);
+    if (bcast && !wasBcast) {
+        bcast_clients.push_back(client);
+        forgetReadsUnlocked(client); // broadcast mode does not use the table
+    }
+    if (!bcast && wasBcast) {
+        bcast_clients.erase(std::remove(bcast_clients.begin(), bcast_clients.end(), client),
+                            bcast_clients.end());
+    }
+    active_clients.store(clients.size(), std::memory_order_relaxed);
+}
+
+void ClientTracking::disable(uint64_t client) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (clients.erase(client) == 0) return;
+    bcast_clients.erase(std::remove(bcast_clients.begin(), bcast_clients.end(), client),
+                        bcast_clients.end());
+    if (pending.erase(client)) pending_count.store(pending.size(), std::memory_order_relaxed);
+    forgetReadsUnlocked(client);
+    active_clients.store(clients.size(), std::memory_order_relaxed);
+}
+
+void ClientTracking::forgetReadsUnlocked(uint64_t client) {
+    auto cit = client_keys.find(client);
+    if (cit == client_keys.end()) return;
+    for (const std::string *key : cit->second) {
+        auto it = table.find(*key);
+        it->second.erase(client);
+        if (it->second.empty()) table.erase(it);
+    }
+    client_keys.erase(cit);
+}
+
+void ClientTracking::eraseKeyUnlocked(KeyTable::iterator it) {
+    for (uint64_t id : it->second) {
+        auto cit = client_keys.find(id);
+        cit->second.erase(&it->first);
+        if (cit->second.empty()) client_keys.erase(cit);
+    }
+    table.erase(it);
+}
+
+void ClientTracking::trackRead(uint64_t client, const std::string &key) {
+    std::lock_guard<std::mutex> lock(mutex);
+    // Only enabled default-mode clients have entries, so disable() can find them all
+    auto info = clients.find(client);
+    if (info == clients.end() || info->second.bcast) return;
+
+    auto it = table.try_emplace(key).first;
+    if (it->second.insert(client).second) client_keys[client].insert(&it->first);
+
+    // Bound memory: evict an arbitrary key, telling its readers to drop it
+    if (table.size() > max_keys) {
+        auto victim = table.begin();
+        if (victim == it) ++victim;
+        if (victim != table.end()) {
+            for (uint64_t id : victim->second) queueUnlocked(id, &victim->first);
+            eraseKeyUnlocked(victim);
+        }
+    }
+}
+
+void ClientTracking::keyModified(const std::string *key) {
+    if (active_clients.load(std::memory_order_relaxed) == 0) return;
+
+    std::lock_guard<std::mutex> lock(mutex);
+    const uint64_t writer = t_current_client;
+
+    if (!key) {
+        for (auto &kv : clients) queueUnlocked(kv.first, nullptr);
+        table.clear();
+        client_keys.clear();
+        return;
+    }
+
+    auto it = table.find(*key);
+    if (it != table.end()) {
+        for (uint64_t id : it->second) {
+            if (id == writer && clients[id].noloop) continue;
+            queueUnlocked(id, key);
+        }
+        eraseKeyUnlocked(it); // clients must read the key again to re-track it
+    }
+
+    for (uint64_t id : bcast_clients) {
+        const ClientInfo &info = clients[id];
+        if (info.noloop && id == writer) continue;
+        bool match = info.prefixes.empty();
+        for (const auto &p : info.prefixes) {
+            if (key->compare(0, p.size(), p) == 0) { match = true; break; }
+        }
+        if (match) queueUnlocked(id, key);
+    }
+}
+
+void ClientTracking::queueUnlocked(uint64_t client, const std::string *key) {
+    Invalidation &inv = pending[client];
+    inv.client = client;
+    if (!key) {
+        inv.flushAll = true;
+        inv.keys.clear();
+    } else if (!inv.flushAll) {
+        inv.keys.push_back(*key);
+    }
+    pending_count.store(pending.size(), std::memory_order_relaxed);
+}
+
+std::vector<ClientTracking::Invalidation> ClientTracking::takeInvalidations() {
+    std::lock_guard<std::mutex> lock(mutex);
+    std::vector<Invalidation> out;
+    out.reserve(pending.size());
+    for (auto &kv : pending) out.push_back(std::move(kv.second));
+    pending.clear();
+    pending_count.store(0, std::memory_order_relaxed);
+    return out;
+}
@@ -1,8 +1,10 @@
 #include "Database.h"
+#include "SimdScan.h"
 #include <fstream>
 #include <sstream>
 #include <stdexcept>
 #include <algorithm>
+#include <random>
 
 using ClockType = std::chrono::steady_clock;
 
@@ -12,6 +14,19 @@ Database& Database::getInstance() {
     return instance;
 }
 
+Database::Database() {
+    lazyfree_thread = std::thread([this] { runLazyFree(); });
+}
+
+Database::~Database() {
+    {
+        std::lock_guard<std::mutex> lock(lazyfree_mutex);
+        lazyfree_stop = true;
+    }
+    lazyfree_cv.notify_one();
+    if (lazyfree_thread.joinable()) lazyfree_thread.join();
+}
+
 // --- internal helpers (mutex must be held) ---
 bool Database::keyExistsUnlocked(const std::string& key) const {
     return kv_store.find(key) != kv_store.end()
@@ -26,15 +41,82 @@ bool Database::isExpiredUnlocked(const std::string& key,
     return now >= it->second;
 }
 
+// Move obj into the lazy free queue; destruction happens on the free thread
+template <typename T>
+void Database::lazyFree(T&& obj) {
+    auto holder = std::make_shared<std::decay_t<T>>(std::move(obj));
+    {
+        std::lock_guard<std::mutex> lock(lazyfree_mutex);
+        lazyfree_queue.push_back(std::move(holder));
+    }
+    lazyfree_cv.notify_one();
+}
+
+bool Database::dropValueUnlocked(const std::string& key) {
+    bool removed = false;
+    if (kv_store.erase(key)) removed = true;
+
+    auto lit = list_store.find(key);
+    if (lit != list_store.end()) {
+        if (lit->second.size() > LAZYFREE_THRESHOLD) lazyFree(std::move(lit->second));
+        list_store.erase(lit);
+        removed = true;
+    }
+    auto hit = hash_store.find(key);
+    if (hit != hash_store.end()) {
+        if (hit->second.size() > LAZYFREE_THRESHOLD) lazyFree(std::move(hit->second));
+        hash_store.erase(hit);
+        removed = true;
+    }
+    return removed;
+}
+
 void Database::removeKeyUnlocked(const std::string& key) {
-    kv_store.erase(key);
-    list_store.erase(key);
-    hash_store.erase(key);
+    if (dropValueUnlocked(key)) keyChangedUnlocked(&key);
     expiries.erase(key);
 }
 
+void Database::keyChangedUnlocked(const std::string* key) {
+    if (key_changed_hook) key_changed_hook(key);
+}
+
+void Database::setKeyChangedHook(KeyChangedHook hook) {
+    std::lock_guard<std::mutex> lock(db_mutex);
+    key_changed_hook = std::move(hook);
+}
+
 // Very small glob matcher: supports '*' and '?'
 bool Database::globMatch(const std::string& str, const std::string& pat) {
+    // Fast path for patterns made of literal segments and '*' only: anchor
+    // the first and last segment, then find the middle ones left to right
+    // with the SIMD literal search (leftmost matching is exact without '?').
+    if (pat.find('?') == std::string::npos) {
+        size_t firstStar = pat.find('*');
+        if (firstStar == std::string::npos) return str == pat;
+
+        size_t lastStar = pat.rfind('*');
+        size_t suffixLen = pat.size() - lastStar - 1;
+        if (firstStar + suffixLen > str.size()) return false;
+        if (str.compare(0, firstStar, pat, 0, firstStar) != 0) return false;
+        if (str.compare(str.size() - suffixLen, suffixLen, pat, lastStar + 1, suffixLen) != 0)
+            return false;
+
+        const char* s = str.data() + firstStar;
+        const char* sEnd = str.data() + str.size() - suffixLen;
+        size_t p = firstStar + 1;
+        while (p < lastStar) {
+            size_t next = pat.find('*', p);
+            size_t segLen = next - p;
+            if (segLen > 0) {
+                const char* hit = SimdScan::findLiteral(s, sEnd, pat.data() + p, segLen);
+                if (hit == sEnd) return false;
+                s = hit + segLen;
+            }
+            p = next + 1;
+        }
+        return true;
+    }
+
     // iterative backtracking
     size_t s = 0, p = 0, star = std::string::npos, ss = 0;
     while (s < str.size()) {
@@ -59,19 +141,108 @@ void Database::purgeExpired() {
     for (auto &k : toErase) removeKeyUnlocked(k);
 }
 
+void Database::flushAll(bool async) {
+    std::lock_guard<std::mutex> lock(db_mutex);
+    if (async) {
+        lazyFree(std::move(kv_store));
+        lazyFree(std::move(list_store));
+        lazyFree(std::move(hash_store));
+    }
+    kv_store.clear();
+    list_store.clear();
+    hash_store.clear();
+    expiries.clear();
+    keyChangedUnlocked(nullptr);
+}
+
+// ---------- Lazy free thread ----------
+void Database::runLazyFree() {
+    while (true) {
+        std::shared_ptr<void> obj;
+        {
+            std::unique_lock<std::mutex> lock(lazyfree_mutex);
+            lazyfree_cv.wait(lock, [this] { return lazyfree_stop || !lazyfree_queue.empty(); });
+            if (lazyfree_queue.empty()) return; // stopped and drained
+            obj = std::move(lazyfree_queue.front());
+            lazyfree_queue.pop_front();
+        }
+        obj.reset(); // destroy outside both locks
+    }
+}
+
+// ---------- Big-key sampler ----------
+// Pick random hash buckets until `count` keys are measured. Work per round
+// is bounded by the probe budget even when the table is sparse; small
+// tables are measured completely.
+template <typename Map, typename SizeFn>
+static void sampleStore(const Map& store, size_t count, SizeFn sizeOf,
+                        KeyProfiler::SizeStats& stats, std::mt19937_64& rng) {
+    stats.keys = store.size();
+    if (store.empty() || count == 0) return;
+    if (store.size() <= count) {
+        for (const auto& kv : store) stats.add(kv.first, sizeOf(kv.second));
+        return;
+    }
+    const size_t buckets = store.bucket_count();
+    size_t probes = count * 8;
+    while (stats.sampled < count && probes-- > 0) {
+        size_t b = static_cast<size_t>(rng() % buckets);
+        for (auto it = store.begin(b); it != store.end(b) && stats.sampled < count; ++it) {
+            stats.add(it->first, sizeOf(it->second));
+        }
+    }
+}
+
+void Database::sampleBigKeys() {
+    const size_t count = key_profiler.bigKeySamples();
+    if (count == 0) return; // disabled
+    KeyProfiler::SizeStats stats[KeyProfiler::TYPE_COUNT];
+    std::vector<std::string> biggest[KeyProfiler::TYPE_COUNT];
+    for (int t = 0; t < KeyProfiler::TYPE_COUNT; ++t) {
+        biggest[t] = key_profiler.biggestKeys(static_cast<KeyProfiler::KeyType>(t));
+    }
+
+    static std::mt19937_64 rng{std::random_device{}()}; // guarded by db_mutex
+    auto strSize = [](const std::string& v) { return v.size(); };
+    auto listSize = [](const std::vector<std::string>& v) { return v.size(); };
+    auto hashSize = [](const std::unordered_map<std::string, std::string>& v) { return v.size(); };
+    // Re-measure last round's biggest keys so deleted or shrunk ones drop out
+    auto remeasure = [&](const auto& store, KeyProfiler::KeyType t, auto sizeOf) {
+        for (const auto& k : biggest[t]) {
+            auto it = store.find(k);
+            if (it != store.end()) stats[t].offerBiggest(k, sizeOf(it->second));
+        }
+    };
+    {
+        std::lock_guard<std::mutex> lock(db_mutex);
+        remeasure(kv_store, KeyProfiler::TYPE_STRING, strSize);
+        remeasure(list_store, KeyProfiler::TYPE_LIST, listSize);
+        remeasure(hash_store, KeyProfiler::TYPE_HASH, hashSize);
+        sampleStore(kv_store, count, strSize, stats[KeyProfiler::TYPE_STRING], rng);
+        sampleStore(list_store, count, listSize, stats[KeyProfiler::TYPE_LIST], rng);
+        sampleStore(hash_store, count, hashSize, stats[KeyProfiler::TYPE_HASH], rng);
+    }
+    key_profiler.setSizeStats(stats);
+}
+
 // ---------- STRING OPS ----------
 bool Database::set(const std::string& key, const std::string& value) {
     std::lock_guard<std::mutex> lock(db_mutex);
+    key_profiler.access(key);
     const auto now = ClockType::now();
     if (isExpiredUnlocked(key, now)) {
         removeKeyUnlocked(key);
+    } else if (list_store.count(key) || hash_store.count(key)) {
+        dropValueUnlocked(key); // overwrite a value of another type
     }
     kv_store[key] = value;
+    keyChangedUnlocked(&key);
     return true;
 }
 
 std::optional<std::string> Database::get(const std::string& key) {
     std::lock_guard<std::mutex> lock(db_mutex);
+    key_profiler.access(key);
     const auto now = ClockType::now();
     if (isExpiredUnlocked(key, now)) {
         removeKeyUnlocked(key);
@@ -84,21 +255,21 @@ std::optional<std::string> Database::get(const std::string& key) {
 
 bool Database::del(const std::string& key) {
     std::lock_guard<std::mutex> lock(db_mutex);
+    key_profiler.access(key);
     const auto now = ClockType::now();
     if (isExpiredUnlocked(key, now)) {
         removeKeyUnlocked(key);
         return false;
     }
-    bool removed = false;
-    if (kv_store.erase(key)) removed = true;
-    if (list_store.erase(key)) removed = true;
-    if (hash_store.erase(key)) removed = true;
+    bool removed = dropValueUnlocked(key);
     expiries.erase(key);
+    if (removed) keyChangedUnlocked(&key);
     return removed;
 }
 
 long Database::incr(const std::string& key) {
     std::lock_guard<std::mutex> lock(db_mutex);
+    key_profiler.access(key);
     const auto now = ClockType::now();
     if (isExpiredUnlocked(key, now)) {
         removeKeyUnlocked(key);
@@ -115,11 +286,13 @@ long Database::incr(const std::string& key) {
     }
     value++;
     kv_store[key] = std::to_string(value);
+    keyChangedUnlocked(&key);
     return value;
 }
 
 bool Database::exists(const std::string& key) const {
     std::lock_guard<std::mutex> lock(db_mutex);
+    key_profiler.access(key);
     const auto now = ClockType::now();
     if (isExpiredUnlocked(key, now)) {
         // Note: we cannot modify maps in const method; treat as not existing.
@@ -131,17 +304,20 @@ bool Database::exists(const std::string& key) const {
 // ---------- LIST OPS ----------
 size_t Database::lpush(const std::string& key, const std::vector<std::string>& values) {
     std::lock_guard<std::mutex> lock(db_mutex);
+    key_profiler.access(key);
     const auto now = ClockType::now();
     if (isExpiredUnlocked(key, now)) {
         removeKeyUnlocked(key);
     }
     auto &lst = list_store[key];
     lst.insert(lst.begin(), values.begin(), values.end());
+    keyChangedUnlocked(&key);
     return lst.size();
 }
 
 std::optional<std::string> Database::lpop(const std::string& key) {
     std::lock_guard<std::mutex> lock(db_mutex);
+    key_profiler.access(key);
     const auto now = ClockType::now();
     if (isExpiredUnlocked(key, now)) {
         removeKeyUnlocked(key);
@@ -151,13 +327,75 @@ std::optional<std::string> Database::lpop(const std::string& key) {
     if (it != list_store.end() && !it->second.empty()) {
         std::string val = it->second.front();
         it->second.erase(it->second.begin());
+        keyChangedUnlocked(&key);
         return val;
     }
     return std::nullopt;
 }
 
+size_t Database::rpush(const std::string& key, const std::vector<std::string>& values) {
+    std::lock_guard<std::mutex> lock(db_mutex);
+    key_profiler.access(key);
+    const auto now = ClockType::now();
+    if (isExpiredUnlocked(key, now)) {
+        removeKeyUnlocked(key);
+    }
+    auto &lst = list_store[key];
+    lst.insert(lst.end(), values.begin(), values.end());
+    keyChangedUnlocked(&key);
+    return lst.size();
+}
+
+std::optional<std::string> Database::rpop(const std::string& key) {
+    std::lock_guard<std::mutex> lock(db_mutex);
+    key_profiler.access(key);
+    const auto now = ClockType::now();
+    if (isExpiredUnlocked(key, now)) {
+        removeKeyUnlocked(key);
+        return std::nullopt;
+    }
+    auto it = list_store.find(key);
+    if (it != list_store.end() && !it->second.empty()) {
+        std::string val = std::move(it->second.back());
+        it->second.pop_back();
+        keyChangedUnlocked(&key);
+        return val;
+    }
+    return std::nullopt;
+}
+
+std::optional<std::string> Database::lmove(const std::string& src, const std::string& dst,
+                                           bool fromLeft, bool toLeft) {
+    std::lock_guard<std::mutex> lock(db_mutex);
+    key_profiler.access(src);
+    key_profiler.access(dst);
+    const auto now = ClockType::now();
+    if (isExpiredUnlocked(src, now)) removeKeyUnlocked(src);
+    if (isExpiredUnlocked(dst, now)) removeKeyUnlocked(dst);
+
+    auto it = list_store.find(src);
+    if (it == list_store.end() || it->second.empty()) return std::nullopt;
+
+    auto &from = it->second;
+    std::string val;
+    if (fromLeft) {
+        val = std::move(from.front());
+        from.erase(from.begin());
+    } else {
+        val = std::move(from.back());
+        from.pop_back();
+    }
+    auto &to = list_store[dst]; // may rehash; `from` is not used past this point
+    if (toLeft) to.insert(to.begin(), val);
+    else to.push_back(val);
+    keyChangedUnlocked(&src);
+    keyChangedUnlocked(&dst);
+    return val;
+}
+
 std::vector<std::string> Database::lrange(const std::string& key, int start, int stop) {
     std::lock_guard<std::mutex> lock(db_mutex);
+    key_profiler.access(key);
     const auto now = ClockType::now();
     if (isExpiredUnlocked(key, now)) {
         removeKeyUnlocked(key);
@@ -190,6 +428,7 @@ std::vector<std::string> Database::lrange(const std::string& key, int start, int
 // ---------- Expiry & key management ----------
 bool Database::expire(const std::string& key, int seconds) {
     std::lock_guard<std::mutex> lock(db_mutex);
+    key_profiler.access(key);
     const auto now = ClockType::now();
     if (isExpiredUnlocked(key, now)) {
         removeKeyUnlocked(key);
@@ -197,11 +436,13 @@ bool Database::expire(const std::string& key, int seconds) {
     }
     if (!keyExistsUnlocked(key)) return false;
     expiries[key] = now + std::chrono::seconds(seconds);
+    keyChangedUnlocked(&key);
     return true;
 }
 
 long Database::ttl(const std::string& key) {
     std::lock_guard<std::mutex> lock(db_mutex);
+    key_profiler.access(key);
     const auto now = ClockType::now();
     if (isExpiredUnlocked(key, now)) {
         removeKeyUnlocked(key);
@@ -267,6 +508,7 @@ bool Database::load(const std::string& filename) {
     list_store.clear();
     hash_store.clear();
     expiries.clear();
+    keyChangedUnlocked(nullptr);
 
     std::string line;
     while (std::getline(ifs, line)) {
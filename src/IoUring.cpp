@@ -0,0 +1,206 @@
+#include "IoUring.h"
+
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/utsname.h>
+#include <unistd.h>
+#include <csignal>
+#include <cstring>
+#include <cerrno>
+#include <cstdio>
+
+static int sys_io_uring_setup(unsigned entries, io_uring_params* p) {
+    return static_cast<int>(syscall(__NR_io_uring_setup, entries, p));
+}
+static int sys_io_uring_enter(int fd, unsigned to_submit, unsigned min_complete,
+                              unsigned flags, const void* arg, size_t argsz) {
+    return static_cast<int>(syscall(__NR_io_uring_enter, fd, to_submit, min_complete,
+                                    flags, arg, argsz));
+}
+static int sys_io_uring_register(int fd, unsigned opcode, void* arg, unsigned nr_args) {
+    return static_cast<int>(syscall(__NR_io_uring_register, fd, opcode, arg, nr_args));
+}
+
+IoUring::~IoUring() {
+    if (br) munmap(br, br_len);
+    if (buf_base) munmap(buf_base, static_cast<size_t>(buf_count) * buf_size);
+    if (sqes) munmap(sqes, sqes_len);
+    if (sq_ptr) munmap(sq_ptr, sq_len);
+    if (ring_fd != -1) close(ring_fd);
+}
+
+bool IoUring::supported() {
+    // Multishot recv landed in 6.0; provided buffer rings in 5.19.
+    utsname u{};
+    if (uname(&u) != 0) return false;
+    int major = 0, minor = 0;
+    if (std::sscanf(u.release, "%d.%d", &major, &minor) != 2) return false;
+    if (major < 6) return false;
+
+    // Seccomp/container policies may still forbid io_uring; probe with a
+    // real buffer-select read from a pipe.
+    IoUring probe;
+    if (!probe.init(4) || !probe.setupBufferRing(0, 2, 64)) return false;
+
+    int fds[2];
+    if (pipe(fds) != 0) return false;
+    bool ok = false;
+    if (write(fds[1], "x", 1) == 1) {
+        io_uring_sqe* sqe = probe.getSqe();
+        sqe->opcode = IORING_OP_READ;
+        sqe->fd = fds[0];
+        sqe->flags = IOSQE_BUFFER_SELECT;
+        sqe->buf_group = 0;
+        sqe->off = static_cast<uint64_t>(-1);
+        if (probe.submitAndWait(100) >= 0) {
+            if (io_uring_cqe* cqe = probe.peekCqe()) {
+                ok = cqe->res == 1 && (cqe->flags & IORING_CQE_F_BUFFER);
+                probe.cqeSeen();
+            }
+        }
+    }
+    close(fds[0]);
+    close(fds[1]);
+    return ok;
+}
+
+bool IoUring::init(unsigned entries) {
+    io_uring_params p{};
+    ring_fd = sys_io_uring_setup(entries, &p);
+    if (ring_fd < 0) { ring_fd = -1; return false; }
+
+    const unsigned need = IORING_FEAT_SINGLE_MMAP | IORING_FEAT_EXT_ARG;
+    if ((p.features & need) != need) { errno = ENOSYS; return false; }
+
+    sq_len = p.sq_off.array + p.sq_entries * sizeof(unsigned);
+    cq_len = p.cq_off.cqes + p.cq_entries * sizeof(io_uring_cqe);
+    if (cq_len > sq_len) sq_len = cq_len;
+    cq_len = sq_len;
+
+    sq_ptr = mmap(nullptr, sq_len, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                  ring_fd, IORING_OFF_SQ_RING);
+    if (sq_ptr == MAP_FAILED) { sq_ptr = nullptr; return false; }
+    cq_ptr = sq_ptr;
+
+    sqes_len = p.sq_entries * sizeof(io_uring_sqe);
+    void* s = mmap(nullptr, sqes_len, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                   ring_fd, IORING_OFF_SQES);
+    if (s == MAP_FAILED) return false;
+    sqes = static_cast<io_uring_sqe*>(s);
+
+    char* sq = static_cast<char*>(sq_ptr);
+    sq_head  = reinterpret_cast<unsigned*>(sq + p.sq_off.head);
+    sq_tail  = reinterpret_cast<unsigned*>(sq + p.sq_off.tail);
+    sq_mask  = reinterpret_cast<unsigned*>(sq + p.sq_off.ring_mask);
+    sq_array = reinterpret_cast<unsigned*>(sq + p.sq_off.array);
+    sq_entries = p.sq_entries;
+    for (unsigned i = 0; i < sq_entries; ++i) sq_array[i] = i;
+    sqe_tail = sqe_submitted = *sq_tail;
+
+    char* cq = static_cast<char*>(cq_ptr);
+    cq_head = reinterpret_cast<unsigned*>(cq + p.cq_off.head);
+    cq_tail = reinterpret_cast<unsigned*>(cq + p.cq_off.tail);
+    cq_mask = reinterpret_cast<unsigned*>(cq + p.cq_off.ring_mask);
+    cqes    = reinterpret_cast<io_uring_cqe*>(cq + p.cq_off.cqes);
+    return true;
+}
+
+bool IoUring::setupBufferRing(uint16_t group, unsigned count, unsigned size) {
+    if (count == 0 || (count & (count - 1)) != 0) { errno = EINVAL; return false; }
+
+    br_len = count * sizeof(io_uring_buf);
+    void* r = mmap(nullptr, br_len, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_POPULATE, -1, 0);
+    if (r == MAP_FAILED) return false;
+    br = static_cast<io_uring_buf_ring*>(r);
+
+    buf_count = count;
+    buf_size = size;
+    void* b = mmap(nullptr, static_cast<size_t>(count) * size, PROT_READ | PROT_WRITE,
+                   MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (b == MAP_FAILED) return false;
+    buf_base = static_cast<char*>(b);
+
+    io_uring_buf_reg reg{};
+    reg.ring_addr = reinterpret_cast<uint64_t>(br);
+    reg.ring_entries = count;
+    reg.bgid = group;
+    if (sys_io_uring_register(ring_fd, IORING_REGISTER_PBUF_RING, &reg, 1) < 0) return false;
+    buf_group = group;
+
+    br_tail = 0;
+    for (unsigned i = 0; i < count; ++i) {
+        io_uring_buf& e = ringEntry(br_tail);
+        e.addr = reinterpret_cast<uint64_t>(buffer(static_cast<uint16_t>(i)));
+        e.len = size;
+        e.bid = static_cast<uint16_t>(i);
+        ++br_tail;
+    }
+    __atomic_store_n(&br->tail, br_tail, __ATOMIC_RELEASE);
+    return true;
+}
+
+void IoUring::recycleBuffer(uint16_t bid) {
+    io_uring_buf& e = ringEntry(br_tail);
+    e.addr = reinterpret_cast<uint64_t>(buffer(bid));
+    e.len = buf_size;
+    e.bid = bid;
+    ++br_tail;
+    __atomic_store_n(&br->tail, br_tail, __ATOMIC_RELEASE);
+}
+
+io_uring_sqe* IoUring::getSqe() {
+    unsigned head = __atomic_load_n(sq_head, __ATOMIC_ACQUIRE);
+    if (sqe_tail - head >= sq_entries) {
+        submit();
+        head = __atomic_load_n(sq_head, __ATOMIC_ACQUIRE);
+        if (sqe_tail - head >= sq_entries) return nullptr;
+    }
+    io_uring_sqe* sqe = &sqes[sqe_tail & *sq_mask];
+    ++sqe_tail;
+    std::memset(sqe, 0, sizeof(*sqe));
+    return sqe;
+}
+
+int IoUring::submit() {
+    unsigned to_submit = sqe_tail - sqe_submitted;
+    if (to_submit == 0) return 0;
+    __atomic_store_n(sq_tail, sqe_tail, __ATOMIC_RELEASE);
+    sqe_submitted = sqe_tail;
+    ++enter_calls;
+    int ret = sys_io_uring_enter(ring_fd, to_submit, 0, 0, nullptr, 0);
+    return ret < 0 ? -errno : ret;
+}
+
+int IoUring::submitAndWait(int timeout_ms) {
+    unsigned to_submit = sqe_tail - sqe_submitted;
+    __atomic_store_n(sq_tail, sqe_tail, __ATOMIC_RELEASE);
+    sqe_submitted = sqe_tail;
+
+    __kernel_timespec ts{};
+    ts.tv_sec = timeout_ms / 1000;
+    ts.tv_nsec = static_cast<long long>(timeout_ms % 1000) * 1000000LL;
+    io_uring_getevents_arg arg{};
+    arg.sigmask_sz = _NSIG / 8;
+    arg.ts = reinterpret_cast<uint64_t>(&ts);
+
+    ++enter_calls;
+    int ret = sys_io_uring_enter(ring_fd, to_submit, 1,
+                                 IORING_ENTER_GETEVENTS | IORING_ENTER_EXT_ARG,
+                                 &arg, sizeof(arg));
+    if (ret < 0) {
+        if (errno == ETIME) return 0;
+        return -errno;
+    }
+    return ret;
+}
+
+io_uring_cqe* IoUring::peekCqe() {
+    unsigned head = *cq_head;
+    unsigned tail = __atomic_load_n(cq_tail, __ATOMIC_ACQUIRE);
+    if (head == tail) return nullptr;
+    return &cqes[head & *cq_mask];
+}
+
+void IoUring::cqeSeen() {
+    __atomic_store_n(cq_head, *cq_head + 1, __ATOMIC_RELEASE);
+}
@@ -0,0 +1,273 @@
+#include "KeyProfiler.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <functional>
+#include <sstream>
+
+// Per-thread xorshift state; seeded lazily so each thread gets its own stream
+static thread_local uint64_t t_rng = 0;
+// Accesses left to skip before the next sample on this thread
+static thread_local uint32_t t_skip = 0;
+
+static uint64_t nextRandom() {
+    if (t_rng == 0) {
+        t_rng = static_cast<uint64_t>(std::chrono::steady_clock::now().time_since_epoch().count())
+              ^ reinterpret_cast<uintptr_t>(&t_rng);
+        if (t_rng == 0) t_rng = 0x9e3779b97f4a7c15ULL;
+    }
+    t_rng ^= t_rng << 13;
+    t_rng ^= t_rng >> 7;
+    t_rng ^= t_rng << 17;
+    return t_rng;
+}
+
+static const char *typeName(KeyProfiler::KeyType type) {
+    switch (type) {
+    case KeyProfiler::TYPE_STRING: return "string";
+    case KeyProfiler::TYPE_LIST:   return "list";
+    default:                       return "hash";
+    }
+}
+
+// ---------- SizeStats ----------
+void KeyProfiler::SizeStats::add(const std::string &key, size_t size) {
+    ++sampled;
+    total += size;
+    // Reservoir sampling keeps the distribution uniform over all sizes seen
+    if (sizes.size() < RESERVOIR) {
+        sizes.push_back(size);
+    } else {
+        uint64_t j = nextRandom() % sampled;
+        if (j < RESERVOIR) sizes[j] = size;
+    }
+    offerBiggest(key, size);
+}
+
+void KeyProfiler::SizeStats::offerBiggest(const std::string &key, size_t size) {
+    if (biggest.size() == BIGGEST && size <= biggest.back().second) return;
+    for (auto &b : biggest) {
+        if (b.first == key) { // already listed (e.g. re-measured and sampled in one round)
+            b.second = std::max(b.second, size);
+            std::sort(biggest.begin(), biggest.end(),
+                      [](const auto &a, const auto &c) { return a.second > c.second; });
+            return;
+        }
+    }
+    auto pos = std::find_if(biggest.begin(), biggest.end(),
+                            [size](const auto &b) { return b.second < size; });
+    biggest.insert(pos, {key, size});
+    if (biggest.size() > BIGGEST) biggest.pop_back();
+}
+
+// ---------- KeyProfiler ----------
+KeyProfiler::KeyProfiler(size_t topK)
+    : top_k(topK), sketch(SKETCH_WIDTH * SKETCH_DEPTH, 0) {}
+
+uint32_t KeyProfiler::sampleWeight() {
+    const uint32_t rate = sample_rate.load(std::memory_order_relaxed);
+    if (rate == 0) return 0;
+    if (t_skip > 0 && t_skip < 2 * rate) {
+        --t_skip;
+        return 0;
+    }
+    // Random gap with mean rate-1, so periodic access patterns cannot alias
+    t_skip = rate > 1 ? static_cast<uint32_t>(nextRandom() % (2 * rate - 1)) : 0;
+    return rate;
+}
+
+// Conservative update: only the smallest counters are raised, which keeps
+// the overestimate of count-min down. Returns the new estimate.
+uint64_t KeyProfiler::incrementSketch(uint64_t hash, uint64_t weight) {
+    const uint64_t h1 = hash;
+    const uint64_t h2 = (hash >> 32) | 1;
+    size_t idx[SKETCH_DEPTH];
+    uint64_t est = UINT64_MAX;
+    for (size_t row = 0; row < SKETCH_DEPTH; ++row) {
+        idx[row] = row * SKETCH_WIDTH + ((h1 + row * h2) & (SKETCH_WIDTH - 1));
+        est = std::min(est, sketch[idx[row]]);
+    }
+    est += weight;
+    for (size_t row = 0; row < SKETCH_DEPTH; ++row) {
+        if (sketch[idx[row]] < est) sketch[idx[row]] = est;
+    }
+    return est;
+}
+
+void KeyProfiler::record(const std::string &key, uint32_t weight) {
+    const uint64_t hash = std::hash<std::string>{}(key);
+    std::lock_guard<std::mutex> lock(mutex);
+    ++samples;
+    since_decay += weight;
+    if (since_decay >= DECAY_ACCESSES) decayUnlocked();
+
+    const uint64_t est = incrementSketch(hash, weight);
+    auto it = heap_pos.find(key);
+    if (it != heap_pos.end()) {
+        heap[it->second].count = est;
+        siftDown(it->second);
+    } else if (heap.size() < top_k) {
+        heap.push_back({key, est});
+        heap_pos[key] = heap.size() - 1;
+        siftUp(heap.size() - 1);
+    } else if (top_k > 0 && est > heap[0].count) {
+        heap_pos.erase(heap[0].key);
+        heap[0].key = key;
+        heap[0].count = est;
+        heap_pos[key] = 0;
+        siftDown(0);
+    }
+}
+
+// Halving is monotonic, so the heap order survives it
+void KeyProfiler::decayUnlocked() {
+    for (auto &c : sketch) c >>= 1;
+    for (auto &h : heap) h.count >>= 1;
+    since_decay = 0;
+}
+
+void KeyProfiler::swapEntries(size_t a, size_t b) {
+    std::swap(heap[a], heap[b]);
+    heap_pos[heap[a].key] = a;
+    heap_pos[heap[b].key] = b;
+}
+
+void KeyProfiler::siftUp(size_t i) {
+    while (i > 0) {
+        size_t parent = (i - 1) / 2;
+        if (heap[parent].count <= heap[i].count) break;
+        swapEntries(i, parent);
+        i = parent;
+    }
+}
+
+void KeyProfiler::siftDown(size_t i) {
+    for (;;) {
+        size_t smallest = i;
+        size_t l = 2 * i + 1, r = l + 1;
+        if (l < heap.size() && heap[l].count < heap[smallest].count) smallest = l;
+        if (r < heap.size() && heap[r].count < heap[smallest].count) smallest = r;
+        if (smallest == i) return;
+        swapEntries(i, smallest);
+        i = smallest;
+    }
+}
+
+std::vector<KeyProfiler::HotKey> KeyProfiler::hotKeys(size_t count) const {
+    std::vector<HotKey> out;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        out = heap;
+    }
+    std::sort(out.begin(), out.end(), [](const HotKey &a, const HotKey &b) {
+        return a.count != b.count ? a.count > b.count : a.key < b.key;
+    });
+    if (out.size() > count) out.resize(count);
+    return out;
+}
+
+std::vector<std::string> KeyProfiler::biggestKeys(KeyType type) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    std::vector<std::string> out;
+    for (const auto &b : size_stats[type].biggest) out.push_back(b.first);
+    return out;
+}
+
+void KeyProfiler::setSizeStats(SizeStats stats[TYPE_COUNT]) {
+    std::lock_guard<std::mutex> lock(mutex);
+    for (int t = 0; t < TYPE_COUNT; ++t) size_stats[t] = std::move(stats[t]);
+}
+
+void KeyProfiler::reset() {
+    std::lock_guard<std::mutex> lock(mutex);
+    std::fill(sketch.begin(), sketch.end(), 0);
+    heap.clear();
+    heap_pos.clear();
+    samples = 0;
+    since_decay = 0;
+    for (auto &s : size_stats) s = SizeStats();
+}
+
+std::string KeyProfiler::report() const {
+    std::ostringstream out;
+    uint64_t sampledAccesses;
+    SizeStats stats[TYPE_COUNT];
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        sampledAccesses = samples;
+        for (int t = 0; t < TYPE_COUNT; ++t) stats[t] = size_stats[t];
+    }
+    auto hot = hotKeys(top_k);
+    out << "# Hotkeys\n";
+    out << "sample_rate:" << sampleRate() << "\n";
+    out << "sampled_accesses:" << sampledAccesses << "\n";
+    for (size_t i = 0; i < hot.size(); ++i) {
+        out << "hot_" << i << ":" << hot[i].key << "=" << hot[i].count << "\n";
+    }
+    out << formatSizes(stats);
+    return out.str();
+}
+
+std::string KeyProfiler::formatSizes(const SizeStats stats[TYPE_COUNT]) {
+    std::ostringstream out;
+    out << "# Bigkeys\n";
+    for (int t = 0; t < TYPE_COUNT; ++t) {
+        const SizeStats &s = stats[t];
+        const char *name = typeName(static_cast<KeyType>(t));
+        std::vector<size_t> sorted = s.sizes;
+        std::sort(sorted.begin(), sorted.end());
+        auto pct = [&sorted](double q) -> size_t { // nearest rank
+            if (sorted.empty()) return 0;
+            size_t rank = static_cast<size_t>(std::ceil(q * static_cast<double>(sorted.size())));
+            return sorted[rank > 0 ? rank - 1 : 0];
+        };
+        out << name << "_keys:" << s.keys << "\n";
+        out << name << "_sampled:" << s.sampled << "\n";
+        out << name << "_avg:" << (s.sampled ? s.total / s.sampled : 0) << "\n";
+        out << name << "_p50:" << pct(0.50) << "\n";
+        out << name << "_p90:" << pct(0.90) << "\n";
+        out << name << "_p99:" << pct(0.99) << "\n";
+        out << name << "_max:" << (s.biggest.empty() ? 0 : s.biggest.front().second) << "\n";
+        for (size_t i = 0; i < s.biggest.size(); ++i) {
+            out << name << "_big_" << i << ":" << s.biggest[i].first << "="
+                << s.biggest[i].second << "\n";
+        }
+    }
+    return out.str();
+}
+
+// Mirrors the parsing in Database::load, counting instead of storing
+bool KeyProfiler::scanSnapshot(const std::string &filename, std::string &out) {
+    std::ifstream ifs(filename, std::ios::binary);
+    if (!ifs) return false;
+
+    SizeStats stats[TYPE_COUNT];
+    std::string line;
+    while (std::getline(ifs, line)) {
+        std::istringstream iss(line);
+        char type;
+        std::string key, item;
+        if (!(iss >> type >> key)) continue;
+        if (type == 'K') {
+            iss >> item;
+            ++stats[TYPE_STRING].keys;
+            stats[TYPE_STRING].add(key, item.size());
+        } else if (type == 'L') {
+            size_t items = 0;
+            while (iss >> item) ++items;
+            ++stats[TYPE_LIST].keys;
+            stats[TYPE_LIST].add(key, items);
+        } else if (type == 'H') {
+            size_t fields = 0;
+            while (iss >> item) {
+                if (item.find(':') != std::string::npos) ++fields;
+            }
+            ++stats[TYPE_HASH].keys;
+            stats[TYPE_HASH].add(key, fields);
+        }
+    }
+    out = "# Snapshot\nfile:" + filename + "\n" + formatSizes(stats);
+    return true;
+}
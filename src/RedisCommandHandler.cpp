@@ -1,10 +1,11 @@
 #include "RedisCommandHandler.h"
 #include "Database.h"
+#include "ClientTracking.h"
+#include "SimdScan.h"
 
-#include <sstream>
 #include <stdexcept>
-#include <iostream>
 #include <cctype>
+#include <cmath>
 
 // Parse RESP array or plain text to vector<string>
 // RESP handled: *N\r\n$len\r\n<data>\r\n...
@@ -12,41 +13,97 @@ std::vector<std::string> RedisCommandHandler::parseRespCommand(const std::string
     std::vector<std::string> tokens;
     if (input.empty()) return tokens;
 
-    // Plain-text fallback (useful with telnet)
-    if (input[0] != '*') {
-        std::istringstream iss(input);
-        std::string token;
-        while (iss >> token) tokens.push_back(token);
-        return tokens;
+    size_t used = parseRespFrame(input.data(), input.size(), tokens);
+    if (used == 0 && input[0] != '*') {
+        // Plain text without a trailing newline (useful with telnet)
+        std::string line = input + "\n";
+        used = parseRespFrame(line.data(), line.size(), tokens);
     }
+    if (used == 0 || used == RESP_PROTOCOL_ERROR) tokens.clear();
+    return tokens;
+}
 
-    size_t pos = 1; // skip '*'
-    try {
-        size_t crlf = input.find("\r\n", pos);
-        if (crlf == std::string::npos) return tokens;
+// Parse a decimal length terminated by CRLF at data[pos..]; on success
+// stores the value and moves pos past the CRLF. Returns 0 if incomplete,
+// -1 if malformed, 1 on success.
+static int parseLengthLine(const char *data, size_t len, size_t &pos, long &out) {
+    size_t p = pos;
+    bool neg = false;
+    if (p < len && data[p] == '-') { neg = true; ++p; }
+    long v = 0;
+    size_t digits = 0;
+    while (p < len && data[p] >= '0' && data[p] <= '9') {
+        v = v * 10 + (data[p] - '0');
+        if (v > (1L << 32)) return -1;
+        ++p; ++digits;
+    }
+    if (p + 1 >= len) return 0;
+    if (digits == 0 || data[p] != '\r' || data[p + 1] != '\n') return -1;
+    out = neg ? -v : v;
+    pos = p + 2;
+    return 1;
+}
 
-        int numElements = std::stoi(input.substr(pos, crlf - pos));
-        pos = crlf + 2;
+static inline bool isInlineSpace(char c) {
+    return c == ' ' || c == '\t' || c == '\r';
+}
 
-        for (int i = 0; i < numElements; ++i) {
-            if (pos >= input.size() || input[pos] != '$') break;
-            pos++; // skip '$'
+size_t RedisCommandHandler::parseRespFrame(const char *data, size_t len,
+                                           std::vector<std::string> &tokens) {
+    if (len == 0) return 0;
 
-            crlf = input.find("\r\n", pos);
-            if (crlf == std::string::npos) break;
+    // Reuse the strings already in `tokens` so a pipelined stream of
+    // similar commands does not allocate per argument
+    size_t count = 0;
+    auto put = [&](const char *s, size_t n) {
+        if (count < tokens.size()) tokens[count].assign(s, n);
+        else tokens.emplace_back(s, n);
+        ++count;
+    };
 
-            int len = std::stoi(input.substr(pos, crlf - pos));
-            pos = crlf + 2;
+    // Plain-text fallback: one command per line, whitespace separated
+    if (data[0] != '*') {
+        const char *end = data + len;
+        const char *nl = SimdScan::findChar(data, end, '\n');
+        if (nl == end) return len > MAX_INLINE_LEN ? RESP_PROTOCOL_ERROR : 0;
+        const char *p = data;
+        while (p < nl) {
+            while (p < nl && isInlineSpace(*p)) ++p;
+            const char *start = p;
+            while (p < nl && !isInlineSpace(*p)) ++p;
+            if (p > start) put(start, static_cast<size_t>(p - start));
+        }
+        tokens.resize(count);
+        return static_cast<size_t>(nl - data) + 1;
+    }
 
-            if (pos + len > input.size()) break;
+    size_t pos = 1; // skip '*'
+    long numElements = 0;
+    int r = parseLengthLine(data, len, pos, numElements);
+    if (r <= 0) return r == 0 ? 0 : RESP_PROTOCOL_ERROR;
+    if (numElements <= 0) { tokens.clear(); return pos; }
+    if (numElements > MAX_MULTIBULK_LEN) return RESP_PROTOCOL_ERROR;
+    if (tokens.capacity() < static_cast<size_t>(numElements) && numElements <= 1024)
+        tokens.reserve(static_cast<size_t>(numElements));
 
-            tokens.push_back(input.substr(pos, len));
-            pos += len + 2; // skip data and CRLF
-        }
-    } catch (const std::exception &e) {
-        std::cerr << "RESP parse error: " << e.what() << std::endl;
+    for (long i = 0; i < numElements; ++i) {
+        if (pos >= len) return 0;
+        if (data[pos] != '$') return RESP_PROTOCOL_ERROR;
+        pos++; // skip '$'
+
+        long argLen = 0;
+        r = parseLengthLine(data, len, pos, argLen);
+        if (r <= 0) return r == 0 ? 0 : RESP_PROTOCOL_ERROR;
+        if (argLen < 0 || argLen > MAX_BULK_LEN) return RESP_PROTOCOL_ERROR;
+
+        size_t n = static_cast<size_t>(argLen);
+        if (pos + n + 2 > len) return 0;
+        if (data[pos + n] != '\r' || data[pos + n + 1] != '\n') return RESP_PROTOCOL_ERROR;
+        put(data + pos, n);
+        pos += n + 2; // skip data and CRLF
     }
-    return tokens;
+    tokens.resize(count);
+    return pos;
 }
 
 RedisCommandHandler::RedisCommandHandler(Database &db) : db_(db) {}
@@ -64,6 +121,9 @@ static std::string okReply() {
 static std::string nilBulk() {
     return "$-1\r\n";
 }
+static std::string nilArray() {
+    return "*-1\r\n";
+}
 static std::string arrayReply(const std::vector<std::string> &arr) {
     std::string out = "*" + std::to_string(arr.size()) + "\r\n";
     for (auto &s : arr) {
@@ -72,9 +132,70 @@ static std::string arrayReply(const std::vector<std::string> &arr) {
     return out;
 }
 
+// LEFT/RIGHT argument of LMOVE/BLMOVE
+static bool parseDirection(std::string dir, bool &left) {
+    for (auto &c : dir) c = static_cast<char>(std::toupper((unsigned char)c));
+    if (dir == "LEFT")  { left = true;  return true; }
+    if (dir == "RIGHT") { left = false; return true; }
+    return false;
+}
+
+// Blocking timeout in seconds; returns an error reply or empty string.
+// The whole argument must be a number, and it is bounded so the deadline
+// computed from it cannot overflow steady_clock.
+static std::string parseTimeout(const std::string &arg, double &timeout) {
+    static constexpr double MAX_TIMEOUT = 1e9; // ~31 years
+    const char *notFloat = "-ERR timeout is not a float or out of range\r\n";
+    if (arg.empty() || std::isspace(static_cast<unsigned char>(arg[0]))) return notFloat;
+    size_t used = 0;
+    try {
+        timeout = std::stod(arg, &used);
+    } catch (...) {
+        return notFloat;
+    }
+    if (used != arg.size()) return notFloat;
+    if (!std::isfinite(timeout) || timeout > MAX_TIMEOUT) return "-ERR timeout is out of range\r\n";
+    if (timeout < 0) return "-ERR timeout is negative\r\n";
+    return "";
+}
+
+void RedisCommandHandler::setReadTracker(ClientTracking *tracker, uint64_t clientId) {
+    tracker_ = tracker;
+    tracker_client_ = clientId;
+}
+
+void RedisCommandHandler::trackRead(const std::string &key) {
+    if (tracker_) tracker_->trackRead(tracker_client_, key);
+}
+
+std::vector<std::string> RedisCommandHandler::takeReadyKeys() {
+    std::vector<std::string> out;
+    out.swap(ready_keys_);
+    return out;
+}
+
+bool RedisCommandHandler::serveBlockedPop(const BlockedPop &b, const std::string &key,
+                                          std::string &reply) {
+    if (b.isMove) {
+        auto v = db_.lmove(key, b.dest, b.fromLeft, b.toLeft);
+        if (!v.has_value()) return false;
+        ready_keys_.push_back(b.dest);
+        reply = bulkString(*v);
+        return true;
+    }
+    auto v = b.fromLeft ? db_.lpop(key) : db_.rpop(key);
+    if (!v.has_value()) return false;
+    reply = arrayReply({key, *v});
+    return true;
+}
+
 // Process commands using the database reference
 std::string RedisCommandHandler::processCommand(const std::string &commandLine) {
-    auto tokens = parseRespCommand(commandLine);
+    return processCommand(parseRespCommand(commandLine));
+}
+
+std::string RedisCommandHandler::processCommand(const std::vector<std::string> &tokens,
+                                                BlockedPop *blocked) {
     if (tokens.empty()) return "-ERR empty command\r\n";
 
     std::string cmd = tokens[0];
@@ -102,6 +223,7 @@ std::string RedisCommandHandler::processCommand(const std::string &commandLine)
     // GET key
     if (cmd == "GET") {
         if (tokens.size() < 2) return "-ERR wrong number of arguments for 'get'\r\n";
+        trackRead(tokens[1]);
         auto v = db_.get(tokens[1]);
         if (v.has_value()) return bulkString(*v);
         return nilBulk();
@@ -114,6 +236,30 @@ std::string RedisCommandHandler::processCommand(const std::string &commandLine)
         return intReply(removed ? 1 : 0);
     }
 
+    // UNLINK key [key ...] (values above the lazy free threshold are freed
+    // in the background; DEL shares the same path)
+    if (cmd == "UNLINK") {
+        if (tokens.size() < 2) return "-ERR wrong number of arguments for 'unlink'\r\n";
+        long removed = 0;
+        for (size_t i = 1; i < tokens.size(); ++i) {
+            if (db_.del(tokens[i])) ++removed;
+        }
+        return intReply(removed);
+    }
+
+    // FLUSHALL [ASYNC|SYNC]
+    if (cmd == "FLUSHALL") {
+        bool async = false;
+        if (tokens.size() >= 2) {
+            std::string mode = tokens[1];
+            for (auto &c : mode) c = static_cast<char>(std::toupper((unsigned char)c));
+            if (mode == "ASYNC") async = true;
+            else if (mode != "SYNC") return "-ERR syntax error\r\n";
+        }
+        db_.flushAll(async);
+        return okReply();
+    }
+
     // INCR key
     if (cmd == "INCR") {
         if (tokens.size() < 2) return "-ERR wrong number of arguments for 'incr'\r\n";
@@ -130,6 +276,16 @@ std::string RedisCommandHandler::processCommand(const std::string &commandLine)
         if (tokens.size() < 3) return "-ERR wrong number of arguments for 'lpush'\r\n";
         std::vector<std::string> values(tokens.begin() + 2, tokens.end());
         size_t newLen = db_.lpush(tokens[1], values);
+        ready_keys_.push_back(tokens[1]);
+        return intReply(static_cast<long>(newLen));
+    }
+
+    // RPUSH key v1 v2 ...
+    if (cmd == "RPUSH") {
+        if (tokens.size() < 3) return "-ERR wrong number of arguments for 'rpush'\r\n";
+        std::vector<std::string> values(tokens.begin() + 2, tokens.end());
+        size_t newLen = db_.rpush(tokens[1], values);
+        ready_keys_.push_back(tokens[1]);
         return intReply(static_cast<long>(newLen));
     }
 
@@ -141,9 +297,78 @@ std::string RedisCommandHandler::processCommand(const std::string &commandLine)
         return nilBulk();
     }
 
+    // RPOP key
+    if (cmd == "RPOP") {
+        if (tokens.size() < 2) return "-ERR wrong number of arguments for 'rpop'\r\n";
+        auto v = db_.rpop(tokens[1]);
+        if (v.has_value()) return bulkString(*v);
+        return nilBulk();
+    }
+
+    // LMOVE src dst LEFT|RIGHT LEFT|RIGHT
+    if (cmd == "LMOVE") {
+        if (tokens.size() != 5) return "-ERR wrong number of arguments for 'lmove'\r\n";
+        bool fromLeft, toLeft;
+        if (!parseDirection(tokens[3], fromLeft) || !parseDirection(tokens[4], toLeft))
+            return "-ERR syntax error\r\n";
+        auto v = db_.lmove(tokens[1], tokens[2], fromLeft, toLeft);
+        if (!v.has_value()) return nilBulk();
+        ready_keys_.push_back(tokens[2]);
+        return bulkString(*v);
+    }
+
+    // BLPOP key [key ...] timeout / BRPOP key [key ...] timeout
+    if (cmd == "BLPOP" || cmd == "BRPOP") {
+        if (tokens.size() < 3) {
+            return cmd == "BLPOP" ? "-ERR wrong number of arguments for 'blpop'\r\n"
+                                  : "-ERR wrong number of arguments for 'brpop'\r\n";
+        }
+        double timeout = 0;
+        std::string err = parseTimeout(tokens.back(), timeout);
+        if (!err.empty()) return err;
+
+        const bool fromLeft = cmd == "BLPOP";
+        for (size_t i = 1; i + 1 < tokens.size(); ++i) {
+            auto v = fromLeft ? db_.lpop(tokens[i]) : db_.rpop(tokens[i]);
+            if (v.has_value()) return arrayReply({tokens[i], *v});
+        }
+        if (!blocked) return nilArray();
+        blocked->keys.assign(tokens.begin() + 1, tokens.end() - 1);
+        blocked->fromLeft = fromLeft;
+        blocked->isMove = false;
+        blocked->timeout = timeout;
+        return "";
+    }
+
+    // BLMOVE src dst LEFT|RIGHT LEFT|RIGHT timeout
+    if (cmd == "BLMOVE") {
+        if (tokens.size() != 6) return "-ERR wrong number of arguments for 'blmove'\r\n";
+        bool fromLeft, toLeft;
+        if (!parseDirection(tokens[3], fromLeft) || !parseDirection(tokens[4], toLeft))
+            return "-ERR syntax error\r\n";
+        double timeout = 0;
+        std::string err = parseTimeout(tokens[5], timeout);
+        if (!err.empty()) return err;
+
+        auto v = db_.lmove(tokens[1], tokens[2], fromLeft, toLeft);
+        if (v.has_value()) {
+            ready_keys_.push_back(tokens[2]);
+            return bulkString(*v);
+        }
+        if (!blocked) return nilBulk();
+        blocked->keys = {tokens[1]};
+        blocked->fromLeft = fromLeft;
+        blocked->isMove = true;
+        blocked->dest = tokens[2];
+        blocked->toLeft = toLeft;
+        blocked->timeout = timeout;
+        return "";
+    }
+
     // LRANGE key start stop
     if (cmd == "LRANGE") {
         if (tokens.size() < 4) return "-ERR wrong number of arguments for 'lrange'\r\n";
+        trackRead(tokens[1]);
         try {
             int start = std::stoi(tokens[2]);
             int stop  = std::stoi(tokens[3]);
@@ -157,6 +382,7 @@ std::string RedisCommandHandler::processCommand(const std::string &commandLine)
     // EXISTS key
     if (cmd == "EXISTS") {
         if (tokens.size() < 2) return "-ERR wrong number of arguments for 'exists'\r\n";
+        trackRead(tokens[1]);
         return intReply(db_.exists(tokens[1]) ? 1 : 0);
     }
 
@@ -174,6 +400,7 @@ std::string RedisCommandHandler::processCommand(const std::string &commandLine)
     // TTL key
     if (cmd == "TTL") {
         if (tokens.size() < 2) return "-ERR wrong number of arguments for 'ttl'\r\n";
+        trackRead(tokens[1]);
         return intReply(db_.ttl(tokens[1]));
     }
 
@@ -184,6 +411,53 @@ std::string RedisCommandHandler::processCommand(const std::string &commandLine)
         return arrayReply(arr);
     }
 
+    // HOTKEYS [COUNT n] | REPORT | RESET | CONFIG SAMPLE-RATE|BIGKEY-SAMPLES n
+    if (cmd == "HOTKEYS") {
+        KeyProfiler &prof = db_.profiler();
+        std::string sub = tokens.size() >= 2 ? tokens[1] : "COUNT";
+        for (auto &c : sub) c = static_cast<char>(std::toupper((unsigned char)c));
+
+        if (sub == "COUNT") {
+            long count = 10;
+            if (tokens.size() >= 3) {
+                try { count = std::stol(tokens[2]); } catch (...) { count = -1; }
+                if (count <= 0) return "-ERR value is out of range, must be positive\r\n";
+            }
+            std::vector<std::string> arr;
+            for (auto &h : prof.hotKeys(static_cast<size_t>(count))) {
+                arr.push_back(h.key);
+                arr.push_back(std::to_string(h.count));
+            }
+            return arrayReply(arr);
+        }
+        if (sub == "REPORT") return bulkString(prof.report());
+        if (sub == "RESET") {
+            prof.reset();
+            return okReply();
+        }
+        if (sub == "CONFIG") {
+            if (tokens.size() != 4) return "-ERR wrong number of arguments for 'hotkeys|config'\r\n";
+            std::string param = tokens[2];
+            for (auto &c : param) c = static_cast<char>(std::toupper((unsigned char)c));
+            long value;
+            try { value = std::stol(tokens[3]); } catch (...) { value = -1; }
+            if (param == "SAMPLE-RATE") {
+                if (value < 0 || value > static_cast<long>(KeyProfiler::MAX_SAMPLE_RATE))
+                    return "-ERR sample rate must be between 0 (off) and 1000000\r\n";
+                prof.setSampleRate(static_cast<uint32_t>(value));
+                return okReply();
+            }
+            if (param == "BIGKEY-SAMPLES") {
+                if (value < 0 || value > static_cast<long>(KeyProfiler::MAX_BIGKEY_SAMPLES))
+                    return "-ERR bigkey samples must be between 0 (off) and 100000\r\n";
+                prof.setBigKeySamples(static_cast<size_t>(value));
+                return okReply();
+            }
+            return "-ERR unknown HOTKEYS CONFIG parameter\r\n";
+        }
+        return "-ERR syntax error\r\n";
+    }
+
     // QUIT (client side disconnect)
     if (cmd == "QUIT" || cmd == "EXIT") {
         return okReply();
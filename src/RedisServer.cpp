@@ -1,9 +1,12 @@
 #include "RedisServer.h"
 #include "RedisCommandHandler.h"
 #include "Database.h"
+#include "IoUring.h"
 
 #include <iostream>
+#include <vector>
 #include <sys/socket.h>
+#include <sys/epoll.h>
 #include <unistd.h>
 #include <netinet/in.h>
 #include <arpa/inet.h>
@@ -20,36 +23,58 @@ static void signal_handler(int signum) {
     }
 }
 
-RedisServer::RedisServer(int port) : port(port), server_socket(-1), running(true) {
+// io_uring user_data layout: fd in the upper bits, operation in the low byte
+enum : uint64_t { OP_ACCEPT = 1, OP_RECV = 2, OP_SEND = 3 };
+static uint64_t makeUserData(int fd, uint64_t op) { return (static_cast<uint64_t>(fd) << 8) | op; }
+
+constexpr uint16_t RECV_BUF_GROUP = 0;
+constexpr unsigned RECV_BUF_COUNT = 1024;   // must be a power of two
+constexpr unsigned RECV_BUF_SIZE  = 4096;
+constexpr int LOOP_TIMEOUT_MS = 100;        // how often the loop rechecks `running`
+
+static std::string peerName(const sockaddr_in &addr) {
+    char ipbuf[INET_ADDRSTRLEN] = {0};
+    inet_ntop(AF_INET, &addr.sin_addr, ipbuf, sizeof(ipbuf));
+    return std::string(ipbuf) + ":" + std::to_string(ntohs(addr.sin_port));
+}
+
+RedisServer::RedisServer(int port, IoBackend backend)
+    : port(port), backend(backend), server_socket(-1), running(true),
+      handler(Database::getInstance()) {
     g_server_ptr = this;
     setupSignalHandler();
+    Database::getInstance().setKeyChangedHook([this](const std::string *key) {
+        tracking.keyModified(key);
+    });
+}
+
+RedisServer::~RedisServer() {
+    Database::getInstance().setKeyChangedHook(nullptr);
+    if (g_server_ptr == this) g_server_ptr = nullptr;
 }
 
 void RedisServer::setupSignalHandler() {
     std::signal(SIGINT,  signal_handler);
     std::signal(SIGTERM, signal_handler);
+    std::signal(SIGPIPE, SIG_IGN);
 }
 
 void RedisServer::shutdown() {
     running = false;
-    if (server_socket != -1) {
-        close(server_socket);
-        server_socket = -1;
-    }
 }
 
-void RedisServer::run() {
-    server_socket = socket(AF_INET, SOCK_STREAM, 0);
+bool RedisServer::setupListenSocket() {
+    server_socket = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK, 0);
     if (server_socket < 0) {
         std::cerr << "Error creating socket: " << strerror(errno) << "\n";
-        return;
+        return false;
     }
 
     int opt = 1;
     if (setsockopt(server_socket, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt)) < 0) {
         std::cerr << "Error setsockopt: " << strerror(errno) << "\n";
         close(server_socket);
-        return;
+        return false;
     }
 
     sockaddr_in serverAddr{};
@@ -60,83 +85,624 @@ void RedisServer::run() {
     if (bind(server_socket, reinterpret_cast<sockaddr*>(&serverAddr), sizeof(serverAddr)) < 0) {
         std::cerr << "Error binding: " << strerror(errno) << "\n";
         close(server_socket);
-        return;
+        return false;
     }
 
-    if (listen(server_socket, 10) < 0) {
+    if (listen(server_socket, SOMAXCONN) < 0) {
         std::cerr << "Error listening: " << strerror(errno) << "\n";
         close(server_socket);
+        return false;
+    }
+    return true;
+}
+
+void RedisServer::run() {
+    if (!setupListenSocket()) return;
+
+    // The support probe sets up a ring and does a read, so run it once
+    bool useUring = backend != IoBackend::Epoll && IoUring::supported();
+    if (backend == IoBackend::IoUring && !useUring) {
+        std::cerr << "io_uring not supported by this kernel, falling back to epoll\n";
+    }
+
+    std::cout << "Server listening on port " << port
+              << " (" << (useUring ? "io_uring" : "epoll") << " backend)\n";
+
+    if (!useUring || !runIoUring()) {
+        runEpoll();
+    }
+
+    for (auto &kv : clients) close(kv.first);
+    clients.clear();
+    close(server_socket);
+    server_socket = -1;
+
+    std::cout << "Processed " << stat_commands << " commands with "
+              << stat_syscalls << " event loop syscalls\n";
+
+    if (!Database::getInstance().dump("dump.my_rdb")) {
+        std::cerr << "Error dumping database\n";
+    } else {
+        std::cout << "Database dumped to dump.my_rdb\n";
+    }
+}
+
+// ---------- shared connection handling ----------
+RedisServer::Connection &RedisServer::addConnection(int fd) {
+    Connection &c = clients[fd];
+    c = Connection{};
+    c.fd = fd;
+    c.id = next_client_id++;
+    fd_by_id[c.id] = fd;
+    sockaddr_in addr{};
+    socklen_t len = sizeof(addr);
+    if (getpeername(fd, reinterpret_cast<sockaddr*>(&addr), &len) == 0) c.peer = peerName(addr);
+    std::cout << "Client connected: " << c.peer << "\n";
+    return c;
+}
+
+void RedisServer::closeConnection(int fd) {
+    auto it = clients.find(fd);
+    if (it == clients.end()) return;
+    if (it->second.blocked) unblockClient(it->second);
+    if (it->second.tracking) tracking.disable(it->second.id);
+    fd_by_id.erase(it->second.id);
+    std::cout << "Client disconnected: " << it->second.peer << "\n";
+    close(fd);
+    clients.erase(it);
+}
+
+void RedisServer::processInput(Connection &c) {
+    if (c.closing) { // input after a protocol error or QUIT is discarded
+        c.inbuf.clear();
         return;
     }
+    std::vector<std::string> tokens;
+    size_t off = 0;
+    while (!c.closing && !c.blocked && off < c.inbuf.size()) {
+        size_t used = RedisCommandHandler::parseRespFrame(c.inbuf.data() + off,
+                                                          c.inbuf.size() - off, tokens);
+        if (used == 0) break; // wait for more data
+        if (used == RedisCommandHandler::RESP_PROTOCOL_ERROR) {
+            c.outbuf += "-ERR Protocol error\r\n";
+            c.closing = true;
+            off = c.inbuf.size();
+            break;
+        }
+        off += used;
+        if (tokens.empty()) continue; // blank inline line
+
+        std::string reply;
+        if (processConnectionCommand(c, tokens, reply)) {
+            c.outbuf += reply;
+            ++stat_commands;
+            continue;
+        }
+
+        BlockedPop block;
+        handler.setReadTracker(c.tracking && !c.trackingBcast ? &tracking : nullptr, c.id);
+        ClientTracking::setCurrentClient(c.id);
+        reply = handler.processCommand(tokens, &block);
+        ClientTracking::setCurrentClient(0);
+        ++stat_commands;
+        if (reply.empty()) {
+            blockClient(c, std::move(block));
+        } else {
+            c.outbuf += reply;
+        }
+        if (handler.hasReadyKeys()) serveBlockedClients();
+
+        // QUIT detection
+        std::string cmd = tokens[0];
+        for (auto &ch : cmd) ch = static_cast<char>(std::toupper((unsigned char)ch));
+        if (cmd == "QUIT" || cmd == "EXIT") c.closing = true;
+    }
+    c.inbuf.erase(0, off);
+
+    // An incomplete command may not grow the buffer without bound
+    if (!c.closing && c.inbuf.size() > RedisCommandHandler::MAX_QUERY_BUFFER) {
+        c.outbuf += "-ERR Protocol error\r\n";
+        c.closing = true;
+        c.inbuf.clear();
+    }
+}
+
+// ---------- connection commands ----------
+static std::string upper(std::string s) {
+    for (auto &ch : s) ch = static_cast<char>(std::toupper((unsigned char)ch));
+    return s;
+}
+
+static std::string bulkArray(const std::vector<std::string> &items) {
+    std::string out = "*" + std::to_string(items.size()) + "\r\n";
+    for (const auto &s : items) out += "$" + std::to_string(s.size()) + "\r\n" + s + "\r\n";
+    return out;
+}
+
+static const char INVALIDATE_CHANNEL[] = "__redis__:invalidate";
+
+bool RedisServer::processConnectionCommand(Connection &c, const std::vector<std::string> &tokens,
+                                           std::string &reply) {
+    const std::string cmd = upper(tokens[0]);
 
-    std::cout << "Server listening on port " << port << "\n";
+    // HELLO [2|3]
+    if (cmd == "HELLO") {
+        if (tokens.size() >= 2) {
+            if (tokens[1] == "2") c.proto = 2;
+            else if (tokens[1] == "3") c.proto = 3;
+            else { reply = "-NOPROTO unsupported protocol version\r\n"; return true; }
+        }
+        reply = (c.proto == 3 ? "%3\r\n" : "*6\r\n");
+        reply += "$6\r\nserver\r\n$5\r\nredis\r\n";
+        reply += "$5\r\nproto\r\n:" + std::to_string(c.proto) + "\r\n";
+        reply += "$2\r\nid\r\n:" + std::to_string(c.id) + "\r\n";
+        return true;
+    }
 
-    Database &db = Database::getInstance();
-    RedisCommandHandler handler(db);
+    // CLIENT ID | TRACKING ... | GETREDIR
+    if (cmd == "CLIENT") {
+        if (tokens.size() < 2) {
+            reply = "-ERR wrong number of arguments for 'client'\r\n";
+            return true;
+        }
+        const std::string sub = upper(tokens[1]);
+        if (sub == "ID") {
+            reply = ":" + std::to_string(c.id) + "\r\n";
+        } else if (sub == "TRACKING") {
+            reply = clientTrackingCommand(c, tokens);
+        } else if (sub == "GETREDIR") {
+            long redir = c.tracking ? static_cast<long>(c.redirect) : -1;
+            reply = ":" + std::to_string(redir) + "\r\n";
+        } else {
+            reply = "-ERR unknown subcommand '" + tokens[1] + "'\r\n";
+        }
+        return true;
+    }
+
+    // SUBSCRIBE __redis__:invalidate (RESP2 invalidation channel only)
+    if (cmd == "SUBSCRIBE") {
+        if (tokens.size() != 2 || tokens[1] != INVALIDATE_CHANNEL) {
+            reply = std::string("-ERR only ") + INVALIDATE_CHANNEL + " can be subscribed\r\n";
+            return true;
+        }
+        c.subscribedInvalidate = true;
+        reply = "*3\r\n$9\r\nsubscribe\r\n$20\r\n__redis__:invalidate\r\n:1\r\n";
+        return true;
+    }
+
+    return false;
+}
+
+// CLIENT TRACKING ON|OFF [REDIRECT id] [BCAST] [PREFIX p ...] [NOLOOP]
+std::string RedisServer::clientTrackingCommand(Connection &c,
+                                               const std::vector<std::string> &tokens) {
+    if (tokens.size() < 3) return "-ERR wrong number of arguments for 'client|tracking'\r\n";
+    const std::string mode = upper(tokens[2]);
+
+    if (mode == "OFF") {
+        if (c.tracking) tracking.disable(c.id);
+        c.tracking = false;
+        c.trackingBcast = false;
+        c.redirect = 0;
+        return "+OK\r\n";
+    }
+    if (mode != "ON") return "-ERR syntax error\r\n";
+
+    uint64_t redirect = 0;
+    bool bcast = false, noloop = false;
+    std::vector<std::string> prefixes;
+    for (size_t i = 3; i < tokens.size(); ++i) {
+        const std::string opt = upper(tokens[i]);
+        if (opt == "BCAST") {
+            bcast = true;
+        } else if (opt == "NOLOOP") {
+            noloop = true;
+        } else if (opt == "REDIRECT" && i + 1 < tokens.size()) {
+            try {
+                redirect = std::stoull(tokens[++i]);
+            } catch (...) {
+                return "-ERR value is not an integer or out of range\r\n";
+            }
+        } else if (opt == "PREFIX" && i + 1 < tokens.size()) {
+            prefixes.push_back(tokens[++i]);
+        } else {
+            return "-ERR syntax error\r\n";
+        }
+    }
+    if (!prefixes.empty() && !bcast)
+        return "-ERR PREFIX option requires BCAST mode to be enabled\r\n";
+    if (redirect != 0 && redirect != c.id && !fd_by_id.count(redirect))
+        return "-ERR The client ID you want redirect to does not exist\r\n";
+
+    c.tracking = true;
+    c.trackingBcast = bcast;
+    c.redirect = redirect == c.id ? 0 : redirect;
+    tracking.enable(c.id, bcast, std::move(prefixes), noloop);
+    return "+OK\r\n";
+}
+
+// Send queued invalidations: RESP3 push to the tracking client (or its
+// redirect target), or a pub/sub message to a RESP2 target subscribed to
+// __redis__:invalidate. Flushes are sent as a null key list.
+void RedisServer::deliverInvalidations() {
+    if (!tracking.hasInvalidations()) return;
+
+    for (auto &inv : tracking.takeInvalidations()) {
+        auto src = fd_by_id.find(inv.client);
+        if (src == fd_by_id.end()) continue;
+        Connection &owner = clients[src->second];
+        auto dst = fd_by_id.find(owner.redirect ? owner.redirect : owner.id);
+        if (dst == fd_by_id.end()) {
+            // The redirect target is gone, so the owner's cache can go stale.
+            // RESP3 owners are told (as Redis does) and are expected to flush
+            // their cache. A RESP2 owner has no channel to be told on, so
+            // tracking is turned off and the connection closed, which makes
+            // client libraries drop the cache.
+            if (owner.proto == 3) {
+                owner.outbuf += ">2\r\n$21\r\ntracking-redir-broken\r\n:"
+                              + std::to_string(owner.redirect) + "\r\n";
+            } else {
+                tracking.disable(owner.id);
+                owner.tracking = false;
+                owner.trackingBcast = false;
+                owner.redirect = 0;
+                owner.closing = true;
+            }
+            touched.push_back(owner.fd);
+            continue;
+        }
+        Connection &target = clients[dst->second];
+
+        std::string msg;
+        if (target.proto == 3) {
+            msg = ">2\r\n$10\r\ninvalidate\r\n";
+            msg += inv.flushAll ? "_\r\n" : bulkArray(inv.keys);
+        } else if (target.subscribedInvalidate) {
+            msg = "*3\r\n$7\r\nmessage\r\n$20\r\n__redis__:invalidate\r\n";
+            msg += inv.flushAll ? "*-1\r\n" : bulkArray(inv.keys);
+        } else {
+            continue; // RESP2 client without an invalidation channel
+        }
+        target.outbuf += msg;
+        touched.push_back(target.fd);
+    }
+}
+
+// ---------- blocking pops ----------
+void RedisServer::blockClient(Connection &c, BlockedPop &&block) {
+    c.blocked = true;
+    c.block = std::move(block);
+    for (const auto &key : c.block.keys) blocked_keys[key].push_back(c.fd);
+    if (c.block.timeout > 0) { // finite and bounded by parseTimeout
+        auto deadline = std::chrono::steady_clock::now()
+                      + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                            std::chrono::duration<double>(c.block.timeout));
+        c.deadline = block_deadlines.emplace(deadline, c.fd);
+        c.hasDeadline = true;
+    }
+}
+
+void RedisServer::unblockClient(Connection &c) {
+    for (const auto &key : c.block.keys) {
+        auto it = blocked_keys.find(key);
+        if (it == blocked_keys.end()) continue;
+        auto &q = it->second;
+        for (auto qit = q.begin(); qit != q.end(); ++qit) {
+            if (*qit == c.fd) { q.erase(qit); break; }
+        }
+        if (q.empty()) blocked_keys.erase(it);
+    }
+    if (c.hasDeadline) {
+        block_deadlines.erase(c.deadline);
+        c.hasDeadline = false;
+    }
+    c.blocked = false;
+    c.block = BlockedPop{};
+}
+
+// Hand elements pushed to watched lists to the clients parked on them,
+// oldest first. Runs right after the pushing command, so no other client
+// can pop the element in between.
+void RedisServer::serveBlockedClients() {
+    if (serving_blocked) return; // the outer call picks up new ready keys
+    serving_blocked = true;
+
+    std::vector<std::string> ready = handler.takeReadyKeys();
+    while (!ready.empty()) {
+        for (const auto &key : ready) {
+            while (true) {
+                auto it = blocked_keys.find(key);
+                if (it == blocked_keys.end()) break;
+                int fd = it->second.front();
+                Connection &c = clients[fd];
+
+                std::string reply;
+                ClientTracking::setCurrentClient(c.id);
+                bool served = handler.serveBlockedPop(c.block, key, reply);
+                ClientTracking::setCurrentClient(0);
+                if (!served) break; // list drained
+                c.outbuf += reply;
+                unblockClient(c);
+                touched.push_back(fd);
+                processInput(c); // resume pipelined commands
+            }
+        }
+        ready = handler.takeReadyKeys(); // BLMOVE destinations, pushes from resumed clients
+    }
+    serving_blocked = false;
+}
+
+void RedisServer::expireBlockedClients() {
+    const auto now = std::chrono::steady_clock::now();
+    while (!block_deadlines.empty() && block_deadlines.begin()->first <= now) {
+        Connection &c = clients[block_deadlines.begin()->second];
+        c.outbuf += c.block.isMove ? "$-1\r\n" : "*-1\r\n";
+        unblockClient(c);
+        touched.push_back(c.fd);
+        processInput(c);
+    }
+}
+
+// Sleep no longer than the nearest blocking-pop deadline
+int RedisServer::loopTimeoutMs() const {
+    if (block_deadlines.empty()) return LOOP_TIMEOUT_MS;
+    auto wait = std::chrono::duration_cast<std::chrono::milliseconds>(
+        block_deadlines.begin()->first - std::chrono::steady_clock::now()).count();
+    if (wait < 0) return 0;
+    if (wait >= LOOP_TIMEOUT_MS) return LOOP_TIMEOUT_MS;
+    return static_cast<int>(wait) + 1;
+}
+
+// ---------- epoll backend ----------
+void RedisServer::runEpoll() {
+    int epfd = epoll_create1(0);
+    if (epfd < 0) {
+        std::cerr << "Error epoll_create1: " << strerror(errno) << "\n";
+        return;
+    }
+    epoll_event ev{};
+    ev.events = EPOLLIN;
+    ev.data.fd = server_socket;
+    epoll_ctl(epfd, EPOLL_CTL_ADD, server_socket, &ev);
+
+    constexpr int MAX_EVENTS = 256;
+    epoll_event events[MAX_EVENTS];
+    char buf[RECV_BUF_SIZE];
 
     while (running) {
-        sockaddr_in clientAddr{};
-        socklen_t clientlen = sizeof(clientAddr);
-        int clientSock = accept(server_socket, reinterpret_cast<sockaddr*>(&clientAddr), &clientlen);
-        if (clientSock < 0) {
+        int n = epoll_wait(epfd, events, MAX_EVENTS, loopTimeoutMs());
+        ++stat_syscalls;
+        if (n < 0) {
             if (errno == EINTR) continue;
-            std::cerr << "Accept error: " << strerror(errno) << "\n";
-            continue;
+            std::cerr << "epoll_wait error: " << strerror(errno) << "\n";
+            break;
         }
 
-        char ipbuf[INET_ADDRSTRLEN] = {0};
-        inet_ntop(AF_INET, &clientAddr.sin_addr, ipbuf, sizeof(ipbuf));
-        uint16_t clientPort = ntohs(clientAddr.sin_port);
-        std::cout << "Client connected: " << ipbuf << ":" << clientPort << "\n";
-
-        constexpr size_t BUF_SZ = 4096;
-        std::string bufferStr;
-        bufferStr.reserve(4096);
-        char buf[BUF_SZ];
-
-        bool clientAlive = true;
-        while (clientAlive && running) {
-            ssize_t n = recv(clientSock, buf, BUF_SZ, 0);
-            if (n > 0) {
-                bufferStr.append(buf, static_cast<size_t>(n));
-
-                // For simplicity, treat buffer as one complete command
-                std::string reply = handler.processCommand(bufferStr);
-
-                // send reply
-                size_t sent = 0;
-                const char* out = reply.c_str();
-                size_t tosend = reply.size();
-                while (sent < tosend) {
-                    ssize_t w = send(clientSock, out + sent, tosend - sent, 0);
-                    if (w <= 0) { clientAlive = false; break; }
-                    sent += static_cast<size_t>(w);
+        for (int i = 0; i < n; ++i) {
+            int fd = events[i].data.fd;
+
+            if (fd == server_socket) {
+                while (true) {
+                    int clientSock = accept4(server_socket, nullptr, nullptr, SOCK_NONBLOCK);
+                    ++stat_syscalls;
+                    if (clientSock < 0) {
+                        if (errno == EINTR) continue;
+                        if (errno != EAGAIN && errno != EWOULDBLOCK)
+                            std::cerr << "Accept error: " << strerror(errno) << "\n";
+                        break;
+                    }
+                    addConnection(clientSock);
+                    epoll_event cev{};
+                    cev.events = EPOLLIN;
+                    cev.data.fd = clientSock;
+                    epoll_ctl(epfd, EPOLL_CTL_ADD, clientSock, &cev);
+                    ++stat_syscalls;
                 }
+                continue;
+            }
 
-                // QUIT detection
-                auto toks = RedisCommandHandler::parseRespCommand(bufferStr);
-                if (!toks.empty()) {
-                    std::string c = toks[0];
-                    for (auto &ch : c) ch = static_cast<char>(std::toupper((unsigned char)ch));
-                    if (c == "QUIT" || c == "EXIT") clientAlive = false;
+            auto it = clients.find(fd);
+            if (it == clients.end()) continue;
+            Connection &c = it->second;
+            touched.push_back(fd);
+
+            if (events[i].events & (EPOLLIN | EPOLLHUP | EPOLLERR)) {
+                while (true) {
+                    ssize_t r = recv(fd, buf, sizeof(buf), 0);
+                    ++stat_syscalls;
+                    if (r > 0) {
+                        c.inbuf.append(buf, static_cast<size_t>(r));
+                        if (static_cast<size_t>(r) < sizeof(buf)) break;
+                    } else if (r == 0) {
+                        c.dead = true; // client closed
+                        break;
+                    } else {
+                        if (errno == EINTR) continue;
+                        if (errno != EAGAIN && errno != EWOULDBLOCK) {
+                            std::cerr << "Recv error: " << strerror(errno) << "\n";
+                            c.dead = true;
+                        }
+                        break;
+                    }
                 }
-                bufferStr.clear();
-            } else if (n == 0) {
-                clientAlive = false; // client closed
-            } else {
-                if (errno == EINTR) continue;
-                std::cerr << "Recv error: " << strerror(errno) << "\n";
-                clientAlive = false;
+                processInput(c);
             }
         }
 
-        close(clientSock);
-        std::cout << "Client disconnected: " << ipbuf << ":" << clientPort << "\n";
+        expireBlockedClients();
+        deliverInvalidations();
+        for (int fd : touched) flushEpoll(epfd, fd);
+        touched.clear();
     }
+    close(epfd);
+}
 
-    if (!Database::getInstance().dump("dump.my_rdb")) {
-        std::cerr << "Error dumping database\n";
-    } else {
-        std::cout << "Database dumped to dump.my_rdb\n";
+// Send pending replies and update EPOLLOUT interest; closes finished clients
+void RedisServer::flushEpoll(int epfd, int fd) {
+    auto it = clients.find(fd);
+    if (it == clients.end()) return;
+    Connection &c = it->second;
+
+    size_t sent = 0;
+    while (!c.dead && sent < c.outbuf.size()) {
+        ssize_t w = send(fd, c.outbuf.data() + sent, c.outbuf.size() - sent, MSG_NOSIGNAL);
+        ++stat_syscalls;
+        if (w > 0) { sent += static_cast<size_t>(w); continue; }
+        if (w < 0 && errno == EINTR) continue;
+        if (w < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) break;
+        c.dead = true;
     }
+    c.outbuf.erase(0, sent);
+
+    if (c.dead || (c.closing && c.outbuf.empty())) {
+        closeConnection(fd);
+        return;
+    }
+
+    bool wantOut = !c.outbuf.empty();
+    if (wantOut != c.epollOut) {
+        epoll_event cev{};
+        cev.events = wantOut ? (EPOLLIN | EPOLLOUT) : EPOLLIN;
+        cev.data.fd = fd;
+        epoll_ctl(epfd, EPOLL_CTL_MOD, fd, &cev);
+        ++stat_syscalls;
+        c.epollOut = wantOut;
+    }
+}
+
+// ---------- io_uring backend ----------
+void RedisServer::armAccept(IoUring &ring) {
+    io_uring_sqe *sqe = ring.getSqe();
+    if (!sqe) return;
+    sqe->opcode = IORING_OP_ACCEPT;
+    sqe->fd = server_socket;
+    sqe->ioprio = IORING_ACCEPT_MULTISHOT;
+    sqe->user_data = makeUserData(server_socket, OP_ACCEPT);
+}
+
+void RedisServer::armRecv(IoUring &ring, Connection &c) {
+    io_uring_sqe *sqe = ring.getSqe();
+    if (!sqe) { c.closing = true; return; }
+    sqe->opcode = IORING_OP_RECV;
+    sqe->fd = c.fd;
+    sqe->ioprio = IORING_RECV_MULTISHOT;
+    sqe->flags = IOSQE_BUFFER_SELECT;
+    sqe->buf_group = RECV_BUF_GROUP;
+    sqe->user_data = makeUserData(c.fd, OP_RECV);
+    c.recvArmed = true;
+}
+
+void RedisServer::armSend(IoUring &ring, Connection &c) {
+    io_uring_sqe *sqe = ring.getSqe();
+    if (!sqe) { c.closing = true; return; }
+    sqe->opcode = IORING_OP_SEND;
+    sqe->fd = c.fd;
+    sqe->addr = reinterpret_cast<uint64_t>(c.inflight.data() + c.inflightSent);
+    sqe->len = static_cast<uint32_t>(c.inflight.size() - c.inflightSent);
+    sqe->msg_flags = MSG_NOSIGNAL;
+    sqe->user_data = makeUserData(c.fd, OP_SEND);
+    c.sendPending = true;
+}
+
+bool RedisServer::runIoUring() {
+    IoUring ring;
+    if (!ring.init(4096) || !ring.setupBufferRing(RECV_BUF_GROUP, RECV_BUF_COUNT, RECV_BUF_SIZE)) {
+        std::cerr << "io_uring setup failed (" << strerror(errno) << "), falling back to epoll\n";
+        return false;
+    }
+
+    armAccept(ring);
+
+    while (running) {
+        expireBlockedClients();
+        deliverInvalidations();
+
+        // Batch: one send per connection with pending replies, submitted
+        // together with the wait below in a single io_uring_enter.
+        for (int fd : touched) {
+            auto it = clients.find(fd);
+            if (it == clients.end()) continue;
+            Connection &c = it->second;
+            if (!c.sendPending && !c.outbuf.empty()) {
+                c.inflight.swap(c.outbuf);
+                c.outbuf.clear();
+                c.inflightSent = 0;
+                armSend(ring, c);
+            }
+            if ((c.closing || !c.recvArmed) && !c.sendPending && c.outbuf.empty()) {
+                if (c.recvArmed) {
+                    // Terminate the multishot recv; close once it reports back
+                    if (!c.shutdownIssued) { ::shutdown(fd, SHUT_RDWR); c.shutdownIssued = true; }
+                } else {
+                    closeConnection(fd);
+                }
+            }
+        }
+        touched.clear();
+
+        int r = ring.submitAndWait(loopTimeoutMs());
+        if (r < 0 && r != -EINTR && r != -EBUSY) {
+            std::cerr << "io_uring_enter error: " << strerror(-r) << "\n";
+            break;
+        }
+
+        while (io_uring_cqe *cqe = ring.peekCqe()) {
+            const uint64_t ud = cqe->user_data;
+            const int res = cqe->res;
+            const uint32_t flags = cqe->flags;
+            ring.cqeSeen();
+
+            const int fd = static_cast<int>(ud >> 8);
+            const uint64_t op = ud & 0xff;
+
+            if (op == OP_ACCEPT) {
+                if (res >= 0) {
+                    Connection &c = addConnection(res);
+                    armRecv(ring, c);
+                } else if (res != -EINVAL && res != -EBADF) {
+                    std::cerr << "Accept error: " << strerror(-res) << "\n";
+                }
+                if (!(flags & IORING_CQE_F_MORE) && running) armAccept(ring);
+                continue;
+            }
+
+            auto it = clients.find(fd);
+            if (it == clients.end()) {
+                if (op == OP_RECV && (flags & IORING_CQE_F_BUFFER))
+                    ring.recycleBuffer(static_cast<uint16_t>(flags >> IORING_CQE_BUFFER_SHIFT));
+                continue;
+            }
+            Connection &c = it->second;
+            touched.push_back(fd);
+
+            if (op == OP_RECV) {
+                if (flags & IORING_CQE_F_BUFFER) {
+                    uint16_t bid = static_cast<uint16_t>(flags >> IORING_CQE_BUFFER_SHIFT);
+                    if (res > 0) c.inbuf.append(ring.buffer(bid), static_cast<size_t>(res));
+                    ring.recycleBuffer(bid);
+                }
+                if (res > 0) processInput(c);
+                if (!(flags & IORING_CQE_F_MORE)) {
+                    c.recvArmed = false;
+                    // Out of provided buffers: re-arm; anything else ends the stream
+                    if (res == -ENOBUFS && !c.shutdownIssued) armRecv(ring, c);
+                    else if (res < 0 && res != -ECONNRESET && !c.shutdownIssued)
+                        std::cerr << "Recv error: " << strerror(-res) << "\n";
+                }
+            } else if (op == OP_SEND) {
+                c.sendPending = false;
+                if (res < 0) {
+                    c.closing = true;
+                    c.outbuf.clear();
+                } else {
+                    c.inflightSent += static_cast<size_t>(res);
+                    if (c.inflightSent < c.inflight.size()) armSend(ring, c);
+                    else { c.inflight.clear(); c.inflightSent = 0; }
+                }
+            }
+        }
+    }
+
+    stat_syscalls += ring.enterCalls();
+    return true;
 }
@@ -0,0 +1,159 @@
+#include "SimdScan.h"
+
+#include <cstring>
+#include <cstdint>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define SIMDSCAN_X86 1
+#endif
+
+// ---------- scalar ----------
+static const char* findCharScalar(const char* p, const char* end, char c) {
+    for (; p < end; ++p) {
+        if (*p == c) return p;
+    }
+    return end;
+}
+
+static const char* findLiteralScalar(const char* p, const char* end, const char* needle, size_t n) {
+    if (static_cast<size_t>(end - p) < n) return end;
+    const char* last = end - n;
+    for (; p <= last; ++p) {
+        if (*p == needle[0] && std::memcmp(p, needle, n) == 0) return p;
+    }
+    return end;
+}
+
+#ifdef SIMDSCAN_X86
+// ---------- SSE2 (baseline on x86-64) ----------
+__attribute__((target("sse2")))
+static const char* findCharSSE2(const char* p, const char* end, char c) {
+    const __m128i pat = _mm_set1_epi8(c);
+    for (; end - p >= 16; p += 16) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+        unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(_mm_cmpeq_epi8(v, pat)));
+        if (mask) return p + __builtin_ctz(mask);
+    }
+    return findCharScalar(p, end, c);
+}
+
+// Compare first and last needle byte at 16 candidate positions at once,
+// then verify the survivors with memcmp.
+__attribute__((target("sse2")))
+static const char* findLiteralSSE2(const char* p, const char* end, const char* needle, size_t n) {
+    if (n == 1) return findCharSSE2(p, end, needle[0]);
+    if (static_cast<size_t>(end - p) < n) return end;
+    const __m128i first = _mm_set1_epi8(needle[0]);
+    const __m128i lastc = _mm_set1_epi8(needle[n - 1]);
+    const char* stop = end - n + 1; // one past the last valid start
+    for (; stop - p >= 16; p += 16) {
+        __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+        __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + n - 1));
+        unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(
+            _mm_and_si128(_mm_cmpeq_epi8(a, first), _mm_cmpeq_epi8(b, lastc))));
+        while (mask) {
+            unsigned bit = static_cast<unsigned>(__builtin_ctz(mask));
+            if (std::memcmp(p + bit + 1, needle + 1, n - 2) == 0) return p + bit;
+            mask &= mask - 1;
+        }
+    }
+    return findLiteralScalar(p, end, needle, n);
+}
+
+// ---------- AVX2 ----------
+__attribute__((target("avx2")))
+static const char* findCharAVX2(const char* p, const char* end, char c) {
+    const __m256i pat = _mm256_set1_epi8(c);
+    for (; end - p >= 32; p += 32) {
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+        unsigned mask = static_cast<unsigned>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(v, pat)));
+        if (mask) return p + __builtin_ctz(mask);
+    }
+    return findCharSSE2(p, end, c);
+}
+
+__attribute__((target("avx2")))
+static const char* findLiteralAVX2(const char* p, const char* end, const char* needle, size_t n) {
+    if (n == 1) return findCharAVX2(p, end, needle[0]);
+    if (static_cast<size_t>(end - p) < n) return end;
+    const __m256i first = _mm256_set1_epi8(needle[0]);
+    const __m256i lastc = _mm256_set1_epi8(needle[n - 1]);
+    const char* stop = end - n + 1;
+    for (; stop - p >= 32; p += 32) {
+        __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+        __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + n - 1));
+        unsigned mask = static_cast<unsigned>(_mm256_movemask_epi8(
+            _mm256_and_si256(_mm256_cmpeq_epi8(a, first), _mm256_cmpeq_epi8(b, lastc))));
+        while (mask) {
+            unsigned bit = static_cast<unsigned>(__builtin_ctz(mask));
+            if (std::memcmp(p + bit + 1, needle + 1, n - 2) == 0) return p + bit;
+            mask &= mask - 1;
+        }
+    }
+    return findLiteralSSE2(p, end, needle, n);
+}
+#endif // SIMDSCAN_X86
+
+// ---------- dispatch ----------
+using FindCharFn = const char* (*)(const char*, const char*, char);
+using FindLiteralFn = const char* (*)(const char*, const char*, const char*, size_t);
+
+// Constant-initialized to scalar so calls made during static init are safe
+static SimdScan::Level g_level = SimdScan::Level::Scalar;
+static FindCharFn g_findChar = findCharScalar;
+static FindLiteralFn g_findLiteral = findLiteralScalar;
+
+SimdScan::Level SimdScan::bestLevel() {
+#ifdef SIMDSCAN_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) return Level::AVX2;
+    if (__builtin_cpu_supports("sse2")) return Level::SSE2;
+#endif
+    return Level::Scalar;
+}
+
+void SimdScan::setLevel(Level l) {
+    if (static_cast<int>(l) > static_cast<int>(bestLevel())) l = bestLevel();
+    g_level = l;
+    switch (l) {
+#ifdef SIMDSCAN_X86
+    case Level::AVX2:
+        g_findChar = findCharAVX2;
+        g_findLiteral = findLiteralAVX2;
+        break;
+    case Level::SSE2:
+        g_findChar = findCharSSE2;
+        g_findLiteral = findLiteralSSE2;
+        break;
+#endif
+    default:
+        g_level = Level::Scalar;
+        g_findChar = findCharScalar;
+        g_findLiteral = findLiteralScalar;
+        break;
+    }
+}
+
+SimdScan::Level SimdScan::level() {
+    return g_level;
+}
+
+const char* SimdScan::levelName(Level l) {
+    switch (l) {
+    case Level::AVX2: return "avx2";
+    case Level::SSE2: return "sse2";
+    default:          return "scalar";
+    }
+}
+
+const char* SimdScan::findChar(const char* p, const char* end, char c) {
+    return g_findChar(p, end, c);
+}
+
+const char* SimdScan::findLiteral(const char* p, const char* end, const char* needle, size_t n) {
+    return g_findLiteral(p, end, needle, n);
+}
+
+// Pick the best level once at startup
+static const bool g_dispatch_init = (SimdScan::setLevel(SimdScan::bestLevel()), true);
@@ -1,15 +1,38 @@
 #include "RedisServer.h"
 #include "Database.h"
+#include "KeyProfiler.h"
 #include <iostream>
 #include <thread>
 #include <chrono>
+#include <string>
 
 int main(int argc, char* argv[]) {
+    // Offline mode: report key sizes in a snapshot and exit
+    if (argc >= 2 && std::string(argv[1]) == "--scan") {
+        std::string file = argc >= 3 ? argv[2] : "dump.my_rdb";
+        std::string report;
+        if (!KeyProfiler::scanSnapshot(file, report)) {
+            std::cerr << "Cannot read " << file << "\n";
+            return 1;
+        }
+        std::cout << report;
+        return 0;
+    }
+
     int port = 6380;
     if (argc >= 2) {
         try { port = std::stoi(argv[1]); } catch (...) { std::cerr << "Invalid port, using 6380\n"; }
     }
 
+    // Network backend: auto (default), epoll or io_uring
+    IoBackend backend = IoBackend::Auto;
+    if (argc >= 3) {
+        std::string b = argv[2];
+        if (b == "epoll") backend = IoBackend::Epoll;
+        else if (b == "io_uring") backend = IoBackend::IoUring;
+        else if (b != "auto") std::cerr << "Unknown backend '" << b << "', using auto\n";
+    }
+
     // Background: periodic DB dump (every 300s)
     std::thread persistenceThread([](){
         while (true) {
@@ -32,10 +55,19 @@ int main(int argc, char* argv[]) {
     });
     expiryThread.detach();
 
+    // Background: big-key sampling (every 1s, HOTKEYS CONFIG BIGKEY-SAMPLES)
+    std::thread bigKeyThread([](){
+        while (true) {
+            std::this_thread::sleep_for(std::chrono::seconds(1));
+            Database::getInstance().sampleBigKeys();
+        }
+    });
+    bigKeyThread.detach();
+
     // Optional: load previous dump (best-effort)
     Database::getInstance().load("dump.my_rdb");
 
-    RedisServer server(port);
+    RedisServer server(port, backend);
     server.run();
     return 0;
 }